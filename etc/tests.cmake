@@ -6,6 +6,7 @@ add_test(NAME t_wrapping_ints_cmp         COMMAND wrapping_integers_cmp)
 add_test(NAME t_wrapping_ints_unwrap      COMMAND wrapping_integers_unwrap)
 add_test(NAME t_wrapping_ints_wrap        COMMAND wrapping_integers_wrap)
 add_test(NAME t_wrapping_ints_roundtrip   COMMAND wrapping_integers_roundtrip)
+add_test(NAME t_tcp_options              COMMAND tcp_options)
 
 add_test(NAME t_recv_connect         COMMAND recv_connect)
 add_test(NAME t_recv_transmit        COMMAND recv_transmit)
@@ -13,6 +14,8 @@ add_test(NAME t_recv_window          COMMAND recv_window)
 add_test(NAME t_recv_reorder         COMMAND recv_reorder)
 add_test(NAME t_recv_close           COMMAND recv_close)
 add_test(NAME t_recv_special         COMMAND recv_special)
+add_test(NAME t_recv_sack            COMMAND recv_sack)
+add_test(NAME t_recv_delayed_ack     COMMAND recv_delayed_ack)
 
 add_test(NAME t_send_connect         COMMAND send_connect)
 add_test(NAME t_send_transmit        COMMAND send_transmit)
@@ -21,6 +24,17 @@ add_test(NAME t_send_window          COMMAND send_window)
 add_test(NAME t_send_ack             COMMAND send_ack)
 add_test(NAME t_send_close           COMMAND send_close)
 add_test(NAME t_send_extra           COMMAND send_extra)
+add_test(NAME t_send_sack            COMMAND send_sack)
+add_test(NAME t_send_congestion      COMMAND send_congestion)
+add_test(NAME t_send_rtt             COMMAND send_rtt)
+add_test(NAME t_send_fast_retx       COMMAND send_fast_retx)
+add_test(NAME t_send_pacing          COMMAND send_pacing)
+add_test(NAME t_send_nagle           COMMAND send_nagle)
+add_test(NAME t_send_repacketize     COMMAND send_repacketize)
+add_test(NAME t_send_tso             COMMAND send_tso)
+add_test(NAME t_send_batch           COMMAND send_batch)
+add_test(NAME t_timer_wheel          COMMAND timer_wheel)
+add_test(NAME t_tcp_window_scale     COMMAND tcp_window_scale)
 
 add_test(NAME t_strm_reassem_single      COMMAND fsm_stream_reassembler_single)
 add_test(NAME t_strm_reassem_seq         COMMAND fsm_stream_reassembler_seq)
@@ -30,12 +44,18 @@ add_test(NAME t_strm_reassem_many        COMMAND fsm_stream_reassembler_many)
 add_test(NAME t_strm_reassem_overlapping COMMAND fsm_stream_reassembler_overlapping)
 add_test(NAME t_strm_reassem_win         COMMAND fsm_stream_reassembler_win)
 add_test(NAME t_strm_reassem_cap         COMMAND fsm_stream_reassembler_cap)
+add_test(NAME t_strm_reassem_engines     COMMAND fsm_stream_reassembler_engines)
+add_test(NAME t_strm_reassem_memory      COMMAND fsm_stream_reassembler_memory)
+add_test(NAME t_strm_reassem_sack        COMMAND fsm_stream_reassembler_sack)
 
 add_test(NAME t_byte_stream_construction COMMAND byte_stream_construction)
 add_test(NAME t_byte_stream_one_write    COMMAND byte_stream_one_write)
 add_test(NAME t_byte_stream_two_writes   COMMAND byte_stream_two_writes)
 add_test(NAME t_byte_stream_capacity     COMMAND byte_stream_capacity)
 add_test(NAME t_byte_stream_many_writes  COMMAND byte_stream_many_writes)
+add_test(NAME t_byte_stream_chunks      COMMAND byte_stream_chunks)
+add_test(NAME t_byte_stream_concurrent  COMMAND byte_stream_concurrent)
+add_test(NAME t_byte_stream_fd          COMMAND byte_stream_fd)
 
 add_test(NAME t_webget               COMMAND "${PROJECT_SOURCE_DIR}/tests/webget_t.sh")
 
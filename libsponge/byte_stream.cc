@@ -1,5 +1,12 @@
 #include "byte_stream.hh"
 
+#include "file_descriptor.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
 // Dummy implementation of a flow-controlled in-memory byte stream.
 
 // For Lab 0, please replace with a real implementation that passes the
@@ -10,40 +17,106 @@
 
 using namespace std;
 
-ByteStream::ByteStream(const size_t capacity) { 
-    b_size = capacity;
+// 环形缓冲区大小取不小于capacity的2的幂，下标用掩码计算
+ByteStream::ByteStream(const size_t capacity)
+    : _ring(round_up_to_power_of_two(capacity)), _mask(_ring.size() - 1), b_size(capacity) {}
+
+size_t ByteStream::write(const string &data) { return write(data.data(), data.size()); }
+
+size_t ByteStream::write(const char *data, const size_t len) {
+    const size_t length = min(len, remaining_capacity());
+    const size_t pos = write_count & _mask;
+    // 最多两次拷贝：写到环尾，剩余部分绕回环首
+    const size_t first = min(length, _ring.size() - pos);
+    memcpy(_ring.data() + pos, data, first);
+    memcpy(_ring.data(), data + first, length - first);
+    write_count += length;
+    return length;
 }
 
-size_t ByteStream::write(const string &data) {
-    size_t rem = remaining_capacity();
-    size_t len = data.size();
-    if(len > rem){
-        len = rem;
-    }
-    size_t i = 0;
-    while(i < len){
-        bts.push_back(data[i]);
-        i++;
-        write_count++;
+size_t ByteStream::write(string &&data) {
+    const size_t len = min(data.size(), remaining_capacity());
+    if (len < MIN_CHUNK_SIZE) {
+        return write(as_const(data));
     }
-     
+    // 接管字符串的存储，不拷贝字节
+    Buffer chunk{move(data)};
+    chunk.remove_suffix(chunk.size() - len);
+    _chunks.emplace_back(write_count, move(chunk));
+    write_count += len;
     return len;
 }
 
+size_t ByteStream::write_from(FileDescriptor &fd, const size_t max) {
+    const size_t len = min(max, remaining_capacity());
+    if (len == 0) {
+        return 0;
+    }
+    // 空闲区最多分成两段，直接作为readv的目标
+    BufferViewList free_space;
+    _ring_views(free_space, write_count, write_count + len);
+    const size_t n = fd.read(free_space.as_iovecs());
+    write_count += n;
+    return n;
+}
+
+void ByteStream::_ring_views(BufferViewList &views, const size_t from, const size_t to) const {
+    const size_t pos = from & _mask;
+    const size_t first = min(to - from, _ring.size() - pos);
+    views.append({_ring.data() + pos, first});
+    views.append({_ring.data(), to - from - first});
+}
+
+template <typename RingF, typename ChunkF>
+void ByteStream::_visit(const size_t len, RingF &&ring_f, ChunkF &&chunk_f) const {
+    size_t pos = read_count;
+    const size_t end = read_count + min(len, buffer_size());
+    for (const auto &[offset, chunk] : _chunks) {
+        if (offset >= end) {
+            break;
+        }
+        // chunk之前的字节在环形区中
+        if (pos < offset) {
+            ring_f(pos, offset);
+            pos = offset;
+        }
+        const size_t n = min(end, offset + chunk.size()) - pos;
+        chunk_f(chunk, pos - offset, n);
+        pos += n;
+    }
+    if (pos < end) {
+        ring_f(pos, end);
+    }
+}
+
 //! \param[in] len bytes will be copied from the output side of the buffer
-string ByteStream::peek_output(const size_t len) const {
-    string s;    
-    s.append(bts.begin(),bts.begin()+len);
-    return s;
+string ByteStream::peek_output(const size_t len) const { return peek_views(len).concatenate(); }
+
+//! \param[in] len bytes will be exposed from the output side of the buffer
+BufferViewList ByteStream::peek_views(const size_t len) const {
+    BufferViewList views;
+    _visit(
+        len,
+        [&](const size_t from, const size_t to) { _ring_views(views, from, to); },
+        [&](const Buffer &chunk, const size_t skip, const size_t n) { views.append(chunk.str().substr(skip, n)); });
+    return views;
 }
 
 //! \param[in] len bytes will be removed from the output side of the buffer
-void ByteStream::pop_output(const size_t len) { 
-    size_t i = 0;
-    while(i<len){
-        bts.pop_front();
-        i++;
-        read_count ++;
+void ByteStream::pop_output(const size_t len) {
+    read_count += min(len, buffer_size());
+    // 丢弃已读完的chunk，截掉部分读取的chunk的前缀
+    while (not _chunks.empty()) {
+        auto &[offset, chunk] = _chunks.front();
+        if (offset + chunk.size() <= read_count) {
+            _chunks.pop_front();
+            continue;
+        }
+        if (offset < read_count) {
+            chunk.remove_prefix(read_count - offset);
+            offset = read_count;
+        }
+        break;
     }
 }
 
@@ -51,25 +124,71 @@ void ByteStream::pop_output(const size_t len) {
 //! \param[in] len bytes will be popped and returned
 //! \returns a string
 std::string ByteStream::read(const size_t len) {
-    size_t length = len;
+    string s = peek_output(len);
+    pop_output(s.size());
+    return s;
+}
 
-    if(length > buffer_size())
-    {
-        length = buffer_size();
-    }
-    string s = peek_output(length);
-    pop_output(length);
+//! \param[in] len bytes will be popped and returned
+//! \returns a BufferList with one Buffer per run of ring bytes or chunk slice
+BufferList ByteStream::read_buffers(const size_t len) {
+    BufferList ret;
+    _visit(
+        len,
+        [&](const size_t from, const size_t to) {
+            BufferViewList views;
+            _ring_views(views, from, to);
+            ret.append(views.concatenate());
+        },
+        [&](const Buffer &chunk, const size_t skip, const size_t n) {
+            Buffer slice = chunk;
+            slice.remove_prefix(skip);
+            slice.remove_suffix(slice.size() - n);
+            ret.append(slice);
+        });
+    pop_output(ret.size());
+    return ret;
+}
 
-    return s;
+//! \param[in] len bytes will be examined from the output side of the buffer
+size_t ByteStream::run_size(const size_t len) const {
+    size_t ret = 0;
+    bool found = false;
+    // 只取第一段
+    _visit(
+        len,
+        [&](const size_t from, const size_t to) {
+            if (not found) {
+                ret = to - from;
+                found = true;
+            }
+        },
+        [&](const Buffer &, const size_t, const size_t n) {
+            if (not found) {
+                ret = n;
+                found = true;
+            }
+        });
+    return ret;
+}
+
+size_t ByteStream::read_into(FileDescriptor &fd, const size_t max) {
+    const BufferViewList data = peek_views(max);
+    if (data.size() == 0) {
+        return 0;
+    }
+    const size_t n = fd.write(data, false);
+    pop_output(n);
+    return n;
 }
 
 void ByteStream::end_input() { end_flag = true;}
 
 bool ByteStream::input_ended() const { return end_flag; }
 
-size_t ByteStream::buffer_size() const { return bts.size(); }
+size_t ByteStream::buffer_size() const { return write_count - read_count; }
 
-bool ByteStream::buffer_empty() const { return bts.empty(); }
+bool ByteStream::buffer_empty() const { return buffer_size() == 0; }
 
 bool ByteStream::eof() const { return (end_flag && buffer_empty()); }
 
@@ -77,4 +196,4 @@ size_t ByteStream::bytes_written() const { return write_count; }
 
 size_t ByteStream::bytes_read() const { return read_count; }
 
-size_t ByteStream::remaining_capacity() const { return {b_size - bts.size()}; }
+size_t ByteStream::remaining_capacity() const { return b_size - buffer_size(); }
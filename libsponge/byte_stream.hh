@@ -1,8 +1,14 @@
 #ifndef SPONGE_LIBSPONGE_BYTE_STREAM_HH
 #define SPONGE_LIBSPONGE_BYTE_STREAM_HH
 
-#include <string>
+#include "buffer.hh"
+
 #include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+class FileDescriptor;
 
 //! \brief An in-order byte stream.
 
@@ -17,14 +23,31 @@ class ByteStream {
     // all, but if any of your tests are taking longer than a second,
     // that's a sign that you probably want to keep exploring
     // different approaches.
-    std::deque<char> bts {};
+    //! Ring storage, sized to the next power of two >= capacity so that
+    //! positions are found by masking the running byte counters.
+    std::vector<char> _ring;
+    size_t _mask;
     size_t b_size = 0;
-    size_t read_count = 0;
-    size_t write_count = 0;
+    size_t read_count = 0;   //!< also the ring position of the next byte to read
+    size_t write_count = 0;  //!< also the ring position of the next byte to write
+    //! Strings handed over by write(std::string&&), keyed by the stream offset of their
+    //! first byte. Their bytes leave the matching ring slots unused.
+    std::deque<std::pair<size_t, Buffer>> _chunks{};
     bool end_flag = false;
     bool _error = false;  //!< Flag indicating that the stream suffered an error.
 
+    //! Append views of the ring storage holding stream bytes [from, to)
+    void _ring_views(BufferViewList &views, const size_t from, const size_t to) const;
+
+    //! Walk the next `len` readable bytes, calling `ring_f(from, to)` for runs held in
+    //! the ring and `chunk_f(chunk, skip, n)` for runs held in a chunk
+    template <typename RingF, typename ChunkF>
+    void _visit(const size_t len, RingF &&ring_f, ChunkF &&chunk_f) const;
+
   public:
+    //! Writes shorter than this are copied into the ring even when passed by rvalue
+    static constexpr size_t MIN_CHUNK_SIZE = 1024;
+
     //! Construct a stream with room for `capacity` bytes.
     ByteStream(const size_t capacity);
 
@@ -36,6 +59,21 @@ class ByteStream {
     //! \returns the number of bytes accepted into the stream
     size_t write(const std::string &data);
 
+    //! Write `len` bytes starting at `data`. Write as many as will fit.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(const char *data, const size_t len);
+
+    //! \brief Write a string the caller no longer needs.
+    //! \details Strings of at least MIN_CHUNK_SIZE bytes are kept as a Buffer
+    //! chunk instead of being copied; bytes past the remaining capacity are dropped.
+    //! \returns the number of bytes accepted into the stream
+    size_t write(std::string &&data);
+
+    //! \brief Read up to `max` bytes from `fd` straight into the stream's free space
+    //! \details One [readv(2)](\ref man2::readv) call; may block if `fd` is blocking.
+    //! \returns the number of bytes accepted into the stream
+    size_t write_from(FileDescriptor &fd, const size_t max);
+
     //! \returns the number of additional bytes that the stream has space for
     size_t remaining_capacity() const;
 
@@ -53,6 +91,12 @@ class ByteStream {
     //! \returns a string
     std::string peek_output(const size_t len) const;
 
+    //! \brief Peek at the next "len" bytes without copying them
+    //! \returns views into the stream's own storage (at most two unless chunks were written)
+    //! \note The views are invalidated by the next write() or pop_output().
+    //! Call pop_output() with the number of bytes consumed to free the space.
+    BufferViewList peek_views(const size_t len) const;
+
     //! Remove bytes from the buffer
     void pop_output(const size_t len);
 
@@ -60,6 +104,20 @@ class ByteStream {
     //! \returns a string
     std::string read(const size_t len);
 
+    //! \brief Read the next "len" bytes as Buffers
+    //! \details Bytes held in chunks come back as slices that share the chunk's storage;
+    //! bytes held in the ring are copied once.
+    BufferList read_buffers(const size_t len);
+
+    //! \returns how many of the next `len` bytes are held in one place (the ring, or a single chunk),
+    //! i.e. how many read_buffers() can return as a single Buffer without copying chunk bytes
+    size_t run_size(const size_t len) const;
+
+    //! \brief Write up to `max` bytes of the stream straight to `fd`, and pop them
+    //! \details One [writev(2)](\ref man2::writev) call; may block if `fd` is blocking.
+    //! \returns the number of bytes popped
+    size_t read_into(FileDescriptor &fd, const size_t max);
+
     //! \returns `true` if the stream input has ended
     bool input_ended() const;
 
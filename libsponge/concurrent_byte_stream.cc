@@ -0,0 +1,120 @@
+#include "concurrent_byte_stream.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+using namespace std;
+
+ConcurrentByteStream::ConcurrentByteStream(const size_t capacity)
+    : _ring(round_up_to_power_of_two(capacity))
+    , _mask(_ring.size() - 1)
+    , _capacity(capacity)
+    , _readable_event(SystemCall("eventfd", eventfd(0, EFD_CLOEXEC)))
+    , _writable_event(SystemCall("eventfd", eventfd(0, EFD_CLOEXEC))) {}
+
+void ConcurrentByteStream::signal(FileDescriptor &event) {
+    const uint64_t one = 1;
+    SystemCall("write", ::write(event.fd_num(), &one, sizeof(one)));
+}
+
+size_t ConcurrentByteStream::write(const string &data) {
+    // 写指针只有写线程修改，读指针需acquire以确保读线程已读完腾出的空间
+    const size_t write_count = _write_count.load(memory_order_relaxed);
+    const size_t read_count = _read_count.load(memory_order_acquire);
+    const size_t len = min(data.size(), _capacity - (write_count - read_count));
+    if (len == 0) {
+        return 0;
+    }
+
+    const size_t pos = write_count & _mask;
+    const size_t first = min(len, _ring.size() - pos);
+    memcpy(_ring.data() + pos, data.data(), first);
+    memcpy(_ring.data(), data.data() + first, len - first);
+
+    _write_count.store(write_count + len, memory_order_release);
+    // 只在状态转换时唤醒：fence与pop_output中的fence配对，双方至少有一方能看到对方的更新
+    atomic_thread_fence(memory_order_seq_cst);
+    const size_t reader_at = _read_count.load(memory_order_relaxed);
+    if (reader_at == write_count) {
+        // 写之前缓冲区为空，读者可能在等待
+        signal(_readable_event);
+    } else if (write_count + len - read_count == _capacity and reader_at != read_count) {
+        // 本次写满了缓冲区，但读者已腾出空间，它可能没有看到"满"而未发出信号
+        signal(_writable_event);
+    }
+    return len;
+}
+
+size_t ConcurrentByteStream::remaining_capacity() const {
+    return _capacity - (_write_count.load(memory_order_relaxed) - _read_count.load(memory_order_acquire));
+}
+
+void ConcurrentByteStream::end_input() {
+    _input_ended.store(true, memory_order_release);
+    signal(_readable_event);
+}
+
+void ConcurrentByteStream::set_error() {
+    _error.store(true, memory_order_release);
+    signal(_readable_event);
+    signal(_writable_event);
+}
+
+void ConcurrentByteStream::wait_writable() {
+    // eventfd的计数不会丢失，先检查再阻塞不会错过唤醒
+    while (remaining_capacity() == 0 and not error()) {
+        _writable_event.read(sizeof(uint64_t));
+    }
+}
+
+string ConcurrentByteStream::peek_output(const size_t len) const {
+    const size_t read_count = _read_count.load(memory_order_relaxed);
+    const size_t length = min(len, _write_count.load(memory_order_acquire) - read_count);
+    const size_t pos = read_count & _mask;
+    const size_t first = min(length, _ring.size() - pos);
+    string s;
+    s.reserve(length);
+    s.append(_ring.data() + pos, first);
+    s.append(_ring.data(), length - first);
+    return s;
+}
+
+void ConcurrentByteStream::pop_output(const size_t len) {
+    const size_t read_count = _read_count.load(memory_order_relaxed);
+    const size_t write_count = _write_count.load(memory_order_acquire);
+    const size_t length = min(len, write_count - read_count);
+    if (length == 0) {
+        return;
+    }
+    _read_count.store(read_count + length, memory_order_release);
+    atomic_thread_fence(memory_order_seq_cst);
+    const size_t writer_at = _write_count.load(memory_order_relaxed);
+    if (writer_at - read_count >= _capacity) {
+        // 读之前缓冲区是满的，写者可能在等待
+        signal(_writable_event);
+    } else if (read_count + length == write_count and writer_at != write_count) {
+        // 本次读空了缓冲区，但写者已写入新数据，它可能没有看到"空"而未发出信号
+        signal(_readable_event);
+    }
+}
+
+string ConcurrentByteStream::read(const size_t len) {
+    string s = peek_output(len);
+    pop_output(s.size());
+    return s;
+}
+
+void ConcurrentByteStream::wait_readable() {
+    while (buffer_empty() and not input_ended() and not error()) {
+        _readable_event.read(sizeof(uint64_t));
+    }
+}
+
+size_t ConcurrentByteStream::buffer_size() const {
+    return _write_count.load(memory_order_acquire) - _read_count.load(memory_order_acquire);
+}
@@ -0,0 +1,126 @@
+#ifndef SPONGE_LIBSPONGE_CONCURRENT_BYTE_STREAM_HH
+#define SPONGE_LIBSPONGE_CONCURRENT_BYTE_STREAM_HH
+
+#include "file_descriptor.hh"
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+//! \brief An in-order byte stream shared by one writer thread and one reader thread.
+
+//! Same interface as ByteStream, but the writer side and the reader side may each be
+//! driven from a different thread without a mutex. The bytes live in a power-of-two
+//! ring; the running write and read counters are the only shared state and are
+//! published with release stores and observed with acquire loads.
+//!
+//! Each side also gets an [eventfd(2)](\ref man2::eventfd) that becomes readable
+//! when the other side makes progress, so the stream can be waited on with
+//! EventLoop::add_rule (the callback must read the event to clear it). Events are
+//! only signalled when the buffer goes from empty to non-empty or from full to
+//! not full, so an event-driven reader (or writer) must drain (or fill) the
+//! stream each time it wakes; operations in between make no system calls.
+class ConcurrentByteStream {
+  private:
+    std::vector<char> _ring;
+    size_t _mask;
+    size_t _capacity;
+
+    alignas(64) std::atomic<size_t> _write_count{0};  //!< only stored by the writer
+    alignas(64) std::atomic<size_t> _read_count{0};   //!< only stored by the reader
+    std::atomic<bool> _input_ended{false};
+    std::atomic<bool> _error{false};
+
+    FileDescriptor _readable_event;  //!< signalled when the buffer stops being empty, and at end of input
+    FileDescriptor _writable_event;  //!< signalled when the buffer stops being full
+
+    //! Add one to an event's counter
+    static void signal(FileDescriptor &event);
+
+  public:
+    //! Construct a stream with room for `capacity` bytes.
+    ConcurrentByteStream(const size_t capacity);
+
+    //! \name "Input" interface for the writer thread
+    //!@{
+
+    //! Write as many bytes as will fit, and return how many were written.
+    size_t write(const std::string &data);
+
+    //! \returns the number of additional bytes that the stream has space for
+    size_t remaining_capacity() const;
+
+    //! Signal that the byte stream has reached its ending
+    void end_input();
+
+    //! Indicate that the stream suffered an error.
+    void set_error();
+
+    //! Block until there is room for at least one byte
+    void wait_writable();
+    //!@}
+
+    //! \name "Output" interface for the reader thread
+    //!@{
+
+    //! Peek at next "len" bytes of the stream
+    std::string peek_output(const size_t len) const;
+
+    //! Remove bytes from the buffer
+    void pop_output(const size_t len);
+
+    //! Read (i.e., copy and then pop) the next "len" bytes of the stream
+    std::string read(const size_t len);
+
+    //! Block until at least one byte can be read or the input has ended
+    void wait_readable();
+
+    //! \returns `true` if the stream input has ended
+    bool input_ended() const { return _input_ended.load(std::memory_order_acquire); }
+
+    //! \returns `true` if the stream has suffered an error
+    bool error() const { return _error.load(std::memory_order_acquire); }
+
+    //! \returns the maximum amount that can currently be read from the stream
+    size_t buffer_size() const;
+
+    //! \returns `true` if the buffer is empty
+    bool buffer_empty() const { return buffer_size() == 0; }
+
+    //! \returns `true` if the output has reached the ending
+    bool eof() const { return input_ended() and buffer_empty(); }
+    //!@}
+
+    //! \name Wakeup hooks
+    //!@{
+
+    //! Readable when bytes or the end of input may be available to the reader
+    FileDescriptor &readable_event() { return _readable_event; }
+
+    //! Readable when space may be available to the writer
+    FileDescriptor &writable_event() { return _writable_event; }
+    //!@}
+
+    //! \name General accounting
+    //!@{
+
+    //! Total number of bytes written
+    size_t bytes_written() const { return _write_count.load(std::memory_order_acquire); }
+
+    //! Total number of bytes popped
+    size_t bytes_read() const { return _read_count.load(std::memory_order_acquire); }
+    //!@}
+};
+
+//! \class ConcurrentByteStream
+//! Example: a reader on an EventLoop
+//!
+//! ~~~{.cpp}
+//! loop.add_rule(stream.readable_event(), Direction::In, [&] {
+//!     stream.readable_event().read(8);  // clear the event before draining
+//!     sink.write(stream.read(stream.buffer_size()));
+//! });
+//! ~~~
+
+#endif  // SPONGE_LIBSPONGE_CONCURRENT_BYTE_STREAM_HH
@@ -0,0 +1,148 @@
+#include "pipe_byte_stream.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <string_view>
+#include <unistd.h>
+
+using namespace std;
+
+static array<int, 2> new_pipe() {
+    array<int, 2> fds{};
+    SystemCall("pipe2", ::pipe2(fds.data(), O_CLOEXEC | O_NONBLOCK));
+    return fds;
+}
+
+PipeByteStream::Pipe::Pipe(const array<int, 2> &fds) : read_end(fds[0]), write_end(fds[1]) {}
+
+//! \param[in] capacity is the requested size; F_SETPIPE_SZ fails with EPERM above
+//!                     `/proc/sys/fs/pipe-max-size`, in which case the default size is kept
+PipeByteStream::Pipe::Pipe(const size_t capacity) : Pipe(new_pipe()) {
+    SystemCall("fcntl", ::fcntl(write_end.fd_num(), F_SETPIPE_SZ, static_cast<int>(capacity)), EPERM);
+}
+
+size_t PipeByteStream::Pipe::size() const { return SystemCall("fcntl", ::fcntl(write_end.fd_num(), F_GETPIPE_SZ)); }
+
+PipeByteStream::PipeByteStream(const size_t capacity)
+    : _pipe(capacity)
+    , _peek(capacity)
+    , _null(SystemCall("open", ::open("/dev/null", O_WRONLY | O_CLOEXEC)))
+    , _capacity(min({capacity, _pipe.size(), _peek.size()}))
+    , _page_size(SystemCall("sysconf", ::sysconf(_SC_PAGESIZE)))
+    , _slot_count(_pipe.size() / _page_size) {}
+
+//! \details Mirrors pipe_write() in the kernel: the part of a write past its last whole page is appended
+//! to the last buffer if that was also written and has room; the rest goes into new buffers a page at a time
+void PipeByteStream::_add_to_slots(size_t len, const bool mergeable) {
+    const size_t tail = len % _page_size;
+    if (mergeable and tail != 0 and not _slots.empty() and _slots.back().mergeable and
+        _slots.back().end + tail <= _page_size) {
+        _slots.back().len += tail;
+        _slots.back().end += tail;
+        len -= tail;
+    }
+    while (len > 0) {
+        const size_t n = min(len, _page_size);
+        _slots.push_back({n, n, mergeable});
+        len -= n;
+    }
+}
+
+void PipeByteStream::_remove_from_slots(size_t len) {
+    while (len > 0 and not _slots.empty()) {
+        const size_t n = min(len, _slots.front().len);
+        _slots.front().len -= n;
+        len -= n;
+        if (_slots.front().len == 0) {
+            _slots.pop_front();
+        }
+    }
+}
+
+size_t PipeByteStream::remaining_capacity() const {
+    // 部分填充的槽位不能再被splice使用，只计空闲槽位和最后一个可追加槽位的剩余空间
+    const size_t free_slots = _slot_count - min(_slot_count, _slots.size());
+    const size_t tail_room =
+        not _slots.empty() and _slots.back().mergeable ? _page_size - _slots.back().end : 0;
+    return min(_capacity - buffer_size(), free_slots * _page_size + tail_room);
+}
+
+size_t PipeByteStream::write(const string &data) {
+    const size_t len = min(data.size(), remaining_capacity());
+    if (len == 0) {
+        return 0;
+    }
+    // 管道是非阻塞的：槽位估计偏少时返回EAGAIN，此时写入0字节而不是抛异常
+    const ssize_t n = SystemCall("write", ::write(_pipe.write_end.fd_num(), data.data(), len), EAGAIN);
+    if (n <= 0) {
+        return 0;
+    }
+    _write_count += n;
+    _add_to_slots(n, true);
+    return n;
+}
+
+size_t PipeByteStream::write_from(FileDescriptor &fd, const size_t max) {
+    const size_t len = min(max, remaining_capacity());
+    if (len == 0) {
+        return 0;
+    }
+    const size_t n = fd.splice_into(_pipe.write_end, len);
+    _write_count += n;
+    _add_to_slots(n, false);
+    return n;
+}
+
+//! \param[in] len bytes will be copied from the output side of the buffer
+string PipeByteStream::peek_output(const size_t len) {
+    const size_t length = min(len, buffer_size());
+    if (length == 0) {
+        return {};
+    }
+    // tee duplicates the pipe's pages without consuming them; only the duplicate is copied out
+    const size_t n = SystemCall(
+        "tee", ::tee(_pipe.read_end.fd_num(), _peek.write_end.fd_num(), length, SPLICE_F_NONBLOCK));
+    string ret;
+    ret.reserve(n);
+    while (ret.size() < n) {
+        ret.append(_peek.read_end.read(n - ret.size()));
+    }
+    return ret;
+}
+
+//! \param[in] len bytes will be removed from the output side of the buffer
+void PipeByteStream::pop_output(const size_t len) {
+    size_t remaining = min(len, buffer_size());
+    while (remaining > 0) {
+        const size_t n = _pipe.read_end.splice_into(_null, remaining);
+        remaining -= n;
+        _read_count += n;
+        _remove_from_slots(n);
+    }
+}
+
+//! \param[in] len bytes will be popped and returned
+string PipeByteStream::read(const size_t len) {
+    const size_t length = min(len, buffer_size());
+    string ret;
+    ret.reserve(length);
+    while (ret.size() < length) {
+        ret.append(_pipe.read_end.read(length - ret.size()));
+    }
+    _read_count += length;
+    _remove_from_slots(length);
+    return ret;
+}
+
+size_t PipeByteStream::read_into(FileDescriptor &fd, const size_t max) {
+    const size_t len = min(max, buffer_size());
+    if (len == 0) {
+        return 0;
+    }
+    const size_t n = _pipe.read_end.splice_into(fd, len);
+    _read_count += n;
+    _remove_from_slots(n);
+    return n;
+}
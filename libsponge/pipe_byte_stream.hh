@@ -0,0 +1,140 @@
+#ifndef SPONGE_LIBSPONGE_PIPE_BYTE_STREAM_HH
+#define SPONGE_LIBSPONGE_PIPE_BYTE_STREAM_HH
+
+#include "file_descriptor.hh"
+
+#include <array>
+#include <deque>
+#include <string>
+
+//! \brief An in-order byte stream whose bytes are held in a kernel pipe.
+
+//! For proxy-style use: bytes are moved between a socket and the stream with
+//! [splice(2)](\ref man2::splice), so the payload never crosses into user space.
+//! When the protocol does need to look at the bytes (e.g. for a checksum),
+//! peek_output() duplicates them with [tee(2)](\ref man2::tee) into a scratch pipe
+//! and reads that copy, leaving the stream itself untouched.
+//!
+//! The accounting interface matches ByteStream. The capacity is limited by how large
+//! the kernel lets a pipe grow (see [pipe(7)](\ref man7::pipe), `/proc/sys/fs/pipe-max-size`).
+//!
+//! The pipes are non-blocking. A pipe holds a fixed number of page-sized slots, and data
+//! spliced from a socket may fill a slot only partially, so the stream keeps a model of the
+//! pipe's slots and remaining_capacity() counts only the room they leave. The model assumes
+//! a splice of `n` bytes takes `n` / page size slots, rounded up; a socket whose data is
+//! fragmented can take more, in which case write() and write_from() accept fewer bytes than
+//! remaining_capacity() (or none) until the reader catches up, but never fail.
+//! write_from() likewise returns 0 when `fd` has nothing to read yet.
+class PipeByteStream {
+  private:
+    //! The two ends of a [pipe(2)](\ref man2::pipe)
+    struct Pipe {
+        FileDescriptor read_end;
+        FileDescriptor write_end;
+
+        //! Make a non-blocking pipe that can hold at least `capacity` bytes, if the kernel allows it
+        explicit Pipe(const size_t capacity);
+
+        //! \returns how many bytes the pipe can hold
+        size_t size() const;
+
+      private:
+        explicit Pipe(const std::array<int, 2> &fds);
+    };
+
+    //! One of `_pipe`'s buffers, as the kernel lays them out
+    struct Slot {
+        size_t len;      //!< unread bytes
+        size_t end;      //!< offset just past the last byte within the page
+        bool mergeable;  //!< filled by write(2), so a later write may append to it
+    };
+
+    Pipe _pipe;            //!< holds the stream bytes
+    Pipe _peek;            //!< scratch pipe for peek_output()
+    FileDescriptor _null;  //!< /dev/null, the sink for pop_output()
+    size_t _capacity;
+    size_t _read_count = 0;
+    size_t _write_count = 0;
+    bool _input_ended = false;
+    bool _error = false;
+    size_t _page_size;
+    size_t _slot_count;          //!< buffers `_pipe` can hold
+    std::deque<Slot> _slots{};  //!< `_pipe`'s buffers, oldest first
+
+    //! Account for `len` bytes added to `_pipe` by write(2) (`mergeable`) or splice(2)
+    void _add_to_slots(size_t len, const bool mergeable);
+
+    //! Account for `len` bytes consumed from `_pipe`
+    void _remove_from_slots(size_t len);
+
+  public:
+    //! Construct a stream with room for `capacity` bytes (or as many as a pipe can hold, if fewer).
+    PipeByteStream(const size_t capacity);
+
+    //! \name "Input" interface for the writer
+    //!@{
+
+    //! Write as many bytes as will fit, and return how many were written.
+    size_t write(const std::string &data);
+
+    //! \brief Move up to `max` bytes from `fd` into the stream with [splice(2)](\ref man2::splice)
+    //! \note sets `fd.eof()` at end of file
+    //! \returns the number of bytes accepted into the stream
+    size_t write_from(FileDescriptor &fd, const size_t max);
+
+    //! \returns the number of additional bytes that the stream has space for, in the pipe's free slots
+    //! and the unused end of its last slot
+    size_t remaining_capacity() const;
+
+    //! Signal that the byte stream has reached its ending
+    void end_input() { _input_ended = true; }
+
+    //! Indicate that the stream suffered an error.
+    void set_error() { _error = true; }
+    //!@}
+
+    //! \name "Output" interface for the reader
+    //!@{
+
+    //! Copy the next "len" bytes of the stream into user space without consuming them
+    std::string peek_output(const size_t len);
+
+    //! Remove bytes from the buffer
+    void pop_output(const size_t len);
+
+    //! Read (i.e., copy and then pop) the next "len" bytes of the stream
+    std::string read(const size_t len);
+
+    //! \brief Move up to `max` bytes of the stream to `fd` with [splice(2)](\ref man2::splice)
+    //! \note returns 0 if `fd` is full
+    //! \returns the number of bytes popped
+    size_t read_into(FileDescriptor &fd, const size_t max);
+
+    //! \returns `true` if the stream input has ended
+    bool input_ended() const { return _input_ended; }
+
+    //! \returns `true` if the stream has suffered an error
+    bool error() const { return _error; }
+
+    //! \returns the maximum amount that can currently be read from the stream
+    size_t buffer_size() const { return _write_count - _read_count; }
+
+    //! \returns `true` if the buffer is empty
+    bool buffer_empty() const { return buffer_size() == 0; }
+
+    //! \returns `true` if the output has reached the ending
+    bool eof() const { return _input_ended and buffer_empty(); }
+    //!@}
+
+    //! \name General accounting
+    //!@{
+
+    //! Total number of bytes written
+    size_t bytes_written() const { return _write_count; }
+
+    //! Total number of bytes popped
+    size_t bytes_read() const { return _read_count; }
+    //!@}
+};
+
+#endif  // SPONGE_LIBSPONGE_PIPE_BYTE_STREAM_HH
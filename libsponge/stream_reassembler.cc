@@ -1,5 +1,11 @@
 #include "stream_reassembler.hh"
 
+#include <algorithm>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
 // Dummy implementation of a stream reassembler.
 
 // For Lab 1, please replace with a real implementation that passes the
@@ -9,7 +15,12 @@
 
 using namespace std;
 
-StreamReassembler::StreamReassembler(const size_t capacity) :  _output(capacity), _capacity(capacity), eof_index(capacity) {
+StreamReassembler::StreamReassembler(const size_t capacity, const Engine engine)
+    : _output(capacity), _capacity(capacity), eof_index(capacity), _engine(engine) {
+    if (_engine == Engine::Bitmap) {
+        _ring.resize(capacity);
+        _present.resize((capacity + 63) / 64);
+    }
 }
 
 //! \details This function accepts a substring (aka a segment) of bytes,
@@ -17,85 +28,361 @@ StreamReassembler::StreamReassembler(const size_t capacity) :  _output(capacity)
 //! contiguous substrings and writes them into the output stream in order.
 // 将字符串子串按顺序写入到输出流中
 void StreamReassembler::push_substring(const string &data, const size_t index, const bool eof) {
-    
-    // 更新滑动窗口位置
-    read_ptr = _output.bytes_read();
-    string ndata = data;
-
-    // 确定发送内容是否位于滑动窗口内，以及eof的位置
-    if((index+data.size())>(read_ptr + _capacity)){
-        ndata = data.substr(0,(read_ptr + _capacity-index));
-    }else if(eof){
-        eof_index = index + ndata.size();     
+    _push(data, index, eof, nullptr);
+}
+
+//! \details Out-of-order bytes are kept as slices of `data` itself, so each byte
+//! is copied once, into the output stream.
+void StreamReassembler::push_substring(Buffer data, const uint64_t index, const bool eof) {
+    _push(data.str(), index, eof, &data);
+}
+
+void StreamReassembler::_push(string_view view, const size_t index, const bool eof, const Buffer *owner) {
+    // 滑动窗口：[第一个未重组字节, 第一个不可接收字节)
+    const size_t first_unassembled = _output.bytes_written();
+    const size_t first_unacceptable = _output.bytes_read() + _capacity;
+    const size_t data_size = view.size();
+    size_t start = index;
+
+    // 整个子串都在窗口内时才记录eof（包括恰好落在窗口边缘的空子串）；被截断的数据不可能带有真正的eof
+    if (eof && index + data_size <= first_unacceptable) {
+        eof_index = index + data_size;
         eof_f = true;
     }
-    
-    // 判断此次发送是否已经存在，若存在进行更新
-    auto it = stream.find(index);
-    if((it != stream.end())){
-        if(ndata.size() > it->second.size()){
-            stream[it->first] = ndata;
-        }       
-    }else{
-        stream.insert({index,ndata});
-    }
-    
-    // 根据发送队列重组写入
-    for(auto iter = stream.begin(); iter != stream.end(); ){
-        size_t old_write = write_ptr;
-        if(iter->first <= old_write){
-            if((iter->first+iter->second.size())>old_write){
-                write_ptr = iter->first+iter->second.size();
-                string write_data(iter->second.substr(old_write - iter->first));
-                _output.write(write_data);
-                iter = stream.erase(iter);
-            }else{
-                iter++;
-            }
-        }else{
+    // 裁掉窗口之外的部分
+    if (start >= first_unacceptable) {
+        view = {};
+    } else if (start + view.size() > first_unacceptable) {
+        view = view.substr(0, first_unacceptable - start);
+    }
+
+    // 裁掉已经写入输出流的部分
+    if (start < first_unassembled) {
+        const size_t skip = min(view.size(), first_unassembled - start);
+        view.remove_prefix(skip);
+        start += skip;
+    }
+
+    if (not view.empty() && _engine == Engine::Bitmap) {
+        if (start == first_unassembled) {
+            // 直接写入输出流，并清除环中已有的相同字节
+            _output.write(view.data(), view.size());
+            _unassembled_bytes -= _bitmap_clear(start % _capacity, view.size());
+            _bitmap_flush();
+        } else {
+            _bitmap_insert(view, start);
+        }
+    } else if (not view.empty()) {
+        if (start == first_unassembled) {
+            _output.write(view.data(), view.size());
+            _flush_pending();
+        } else if (owner) {
+            // 引用原Buffer的一段，不拷贝
+            Buffer slice = *owner;
+            slice.remove_prefix(static_cast<size_t>(view.data() - owner->str().data()));
+            slice.remove_suffix(slice.size() - view.size());
+            _enforce_memory_limit(_insert_pending(move(slice), start));
+        } else {
+            _enforce_memory_limit(_insert_pending(string(view), start));
+        }
+    }
+
+    if (eof_f && (_output.bytes_written() == eof_index)) {
+        _output.end_input();
+    }
+}
+
+map<size_t, Buffer>::iterator StreamReassembler::_insert_pending(Buffer data, size_t index) {
+    size_t end = index + data.size();
+    auto next = _pending.lower_bound(index);
+
+    // 与前一个区间重叠：裁掉新数据的前缀
+    if (next != _pending.begin()) {
+        const auto prev = std::prev(next);
+        const size_t prev_end = prev->first + prev->second.size();
+        if (prev_end >= end) {
+            return _pending.end();
+        }
+        if (prev_end > index) {
+            data.remove_prefix(prev_end - index);
+            index = prev_end;
+        }
+    }
+
+    // 删除被完全覆盖的区间；与后一个区间重叠时裁掉新数据的后缀
+    while (next != _pending.end() && next->first < end) {
+        const size_t next_end = next->first + next->second.size();
+        if (next_end > end) {
+            data.remove_suffix(end - next->first);
+            end = next->first;
             break;
         }
-    }   
+        _unassembled_bytes -= next->second.size();
+        next = _pending.erase(next);
+    }
+
+    if (data.size() == 0) {
+        return _pending.end();
+    }
+    _unassembled_bytes += data.size();
+    return _pending.emplace_hint(next, index, move(data));
+}
+
+void StreamReassembler::set_memory_limit(const size_t bytes, const EvictionPolicy policy) {
+    _memory_limit = bytes;
+    _eviction_policy = policy;
+    _enforce_memory_limit(_pending.end());
+}
+
+size_t StreamReassembler::memory_usage() const { return _unassembled_bytes + _pending.size() * FRAGMENT_OVERHEAD; }
+
+StreamReassembler::MemoryStats StreamReassembler::memory_stats() const {
+    MemoryStats stats;
+    stats.fragments = _pending.size();
+    stats.payload_bytes = _unassembled_bytes;
+    stats.overhead_bytes = _pending.size() * FRAGMENT_OVERHEAD;
+    stats.evictions = _evictions;
+    stats.evicted_bytes = _evicted_bytes;
+    stats.coalesced = _coalesced;
+    return stats;
+}
+
+void StreamReassembler::_enforce_memory_limit(map<size_t, Buffer>::iterator newest) {
+    if (memory_usage() <= _memory_limit) {
+        return;
+    }
+
+    if (_eviction_policy == EvictionPolicy::DropNewest && newest != _pending.end()) {
+        _evict(newest);
+    } else if (_eviction_policy == EvictionPolicy::Coalesce) {
+        _coalesce();
+    }
+
+    // 仍然超出限制：丢弃序号最大的分片
+    while (memory_usage() > _memory_limit && not _pending.empty()) {
+        _evict(std::prev(_pending.end()));
+    }
+}
+
+void StreamReassembler::_evict(map<size_t, Buffer>::iterator it) {
+    _unassembled_bytes -= it->second.size();
+    _evicted_bytes += it->second.size();
+    ++_evictions;
+    _pending.erase(it);
+}
+
+void StreamReassembler::_coalesce() {
+    auto run = _pending.begin();
+    while (run != _pending.end()) {
+        // 找到首尾相接的一段分片
+        auto last = run;
+        size_t run_end = run->first + run->second.size();
+        size_t run_size = run->second.size();
+        while (std::next(last) != _pending.end() && std::next(last)->first == run_end) {
+            ++last;
+            run_end += last->second.size();
+            run_size += last->second.size();
+        }
+        if (last == run) {
+            ++run;
+            continue;
+        }
 
-    // 发送完毕后整理后续发送队列内容
-    auto old_it = stream.begin();
-    for(auto iter = stream.begin(); iter != stream.end(); ){
-        if(iter != stream.begin()){
-            if(iter->first < (old_it->first+old_it->second.size()))
-            {
-                if((iter->first+iter->second.size())<= (old_it->first+old_it->second.size()))
-                {
-                    iter = stream.erase(iter);
-                }else{
-                    string s = old_it->second + iter->second.substr((old_it->first+old_it->second.size())-iter->first);
-                    old_it->second = s;
-                    iter = stream.erase(iter);
-                }
+        string merged;
+        merged.reserve(run_size);
+        const auto stop = std::next(last);
+        for (auto it = run; it != stop; ++it) {
+            merged.append(it->second.str());
+            ++_coalesced;
+        }
+        --_coalesced;
+        const size_t index = run->first;
+        _pending.erase(run, stop);
+        run = std::next(_pending.emplace_hint(stop, index, move(merged)));
+    }
+}
 
-            }else{
-                old_it = iter++;
-            }        
-        }else{
-            old_it = iter++;
+void StreamReassembler::_flush_pending() {
+    auto it = _pending.begin();
+    while (it != _pending.end() && it->first <= _output.bytes_written()) {
+        const size_t written = _output.bytes_written();
+        const size_t it_end = it->first + it->second.size();
+        if (it_end > written) {
+            const string_view piece = it->second.str().substr(written - it->first);
+            _output.write(piece.data(), piece.size());
         }
+        _unassembled_bytes -= it->second.size();
+        it = _pending.erase(it);
+    }
+}
+
+namespace {
+
+//! Set bits [from, to) of `words`; returns how many were newly set
+size_t set_range(vector<uint64_t> &words, size_t from, const size_t to) {
+    size_t added = 0;
+    while (from < to) {
+        const size_t bit = from % 64;
+        const size_t n = min<size_t>(64 - bit, to - from);
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : ((uint64_t{1} << n) - 1)) << bit;
+        uint64_t &word = words[from / 64];
+        added += __builtin_popcountll(~word & mask);
+        word |= mask;
+        from += n;
     }
+    return added;
+}
 
-    if((write_ptr == eof_index) && eof_f){
-        _output.end_input();
+//! Clear bits [from, to) of `words`; returns how many were previously set
+size_t clear_range(vector<uint64_t> &words, size_t from, const size_t to) {
+    size_t removed = 0;
+    while (from < to) {
+        const size_t bit = from % 64;
+        const size_t n = min<size_t>(64 - bit, to - from);
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : ((uint64_t{1} << n) - 1)) << bit;
+        uint64_t &word = words[from / 64];
+        removed += __builtin_popcountll(word & mask);
+        word &= ~mask;
+        from += n;
     }
+    return removed;
 }
 
-// 统计以发出但还未被写入的字符数
-size_t StreamReassembler::unassembled_bytes() const { 
-    size_t unassem = 0;
-    for(auto iter = stream.begin(); iter != stream.end(); iter++ ){
-        if(iter->first > write_ptr){
-            unassem += iter->second.size();
+//! Number of consecutive set bits in `words` starting at `from`, stopping at `to`
+size_t run_length(const vector<uint64_t> &words, const size_t from, const size_t to) {
+    size_t pos = from;
+    while (pos < to) {
+        const size_t bit = pos % 64;
+#ifdef __AVX2__
+        // 一次检查256位是否全部为1
+        if (bit == 0 && to - pos >= 256) {
+            const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&words[pos / 64]));
+            if (_mm256_testc_si256(v, _mm256_set1_epi64x(-1))) {
+                pos += 256;
+                continue;
+            }
         }
+#endif
+        const uint64_t holes = ~words[pos / 64] >> bit;
+        if (holes != 0) {
+            pos += __builtin_ctzll(holes);
+            break;
+        }
+        pos += 64 - bit;
     }
-    return unassem; 
+    return min(pos, to) - from;
 }
 
-bool StreamReassembler::empty() const { 
-    return {unassembled_bytes() == 0}; 
+//! One past the last bit in [lo, hi) of `words` equal to `value`, or `lo` if there is none
+size_t last_equal(const vector<uint64_t> &words, const size_t lo, const size_t hi, const bool value) {
+    size_t pos = hi;
+    while (pos > lo) {
+        const size_t word_start = (pos - 1) / 64 * 64;
+        const size_t from = max(lo, word_start);
+        const uint64_t word = value ? words[word_start / 64] : ~words[word_start / 64];
+        const size_t n = pos - from;
+        const uint64_t mask = (n == 64 ? ~uint64_t{0} : ((uint64_t{1} << n) - 1)) << (from - word_start);
+        if (word & mask) {
+            return word_start + 64 - __builtin_clzll(word & mask);
+        }
+        pos = from;
+    }
+    return lo;
 }
+
+}  // namespace
+
+size_t StreamReassembler::_bitmap_set(const size_t from, const size_t len) {
+    const size_t first = min(len, _capacity - from);
+    return set_range(_present, from, from + first) + set_range(_present, 0, len - first);
+}
+
+size_t StreamReassembler::_bitmap_clear(const size_t from, const size_t len) {
+    const size_t first = min(len, _capacity - from);
+    return clear_range(_present, from, from + first) + clear_range(_present, 0, len - first);
+}
+
+size_t StreamReassembler::_bitmap_run(const size_t from, const size_t max) const {
+    const size_t first = run_length(_present, from, min(_capacity, from + max));
+    if (from + first < _capacity || first == max) {
+        return first;
+    }
+    return first + run_length(_present, 0, max - first);
+}
+
+uint64_t StreamReassembler::_bitmap_last(const uint64_t lo, const uint64_t hi, const bool present) const {
+    // 环中[lo, hi)可能分为两段：先查序号较大的那一段
+    const size_t lo_slot = lo % _capacity;
+    const uint64_t wrap = lo + (_capacity - lo_slot);
+    if (hi > wrap) {
+        const size_t r = last_equal(_present, 0, hi - wrap, present);
+        if (r > 0) {
+            return wrap + r;
+        }
+    }
+    const size_t lo_end = lo_slot + (min(hi, wrap) - lo);
+    return lo + (last_equal(_present, lo_slot, lo_end, present) - lo_slot);
+}
+
+void StreamReassembler::_bitmap_insert(const string_view data, const size_t index) {
+    // 按最终位置拷贝到环中，最多分两段
+    const size_t slot = index % _capacity;
+    const size_t first = min(data.size(), _capacity - slot);
+    copy_n(data.data(), first, _ring.begin() + slot);
+    copy_n(data.data() + first, data.size() - first, _ring.begin());
+    _unassembled_bytes += _bitmap_set(slot, data.size());
+}
+
+void StreamReassembler::_bitmap_flush() {
+    const size_t slot = _output.bytes_written() % _capacity;
+    const size_t len = _bitmap_run(slot, _capacity);
+    if (len == 0) {
+        return;
+    }
+    const size_t first = min(len, _capacity - slot);
+    _output.write(_ring.data() + slot, first);
+    _output.write(_ring.data(), len - first);
+    _unassembled_bytes -= _bitmap_clear(slot, len);
+}
+
+vector<StreamReassembler::SackBlock> StreamReassembler::sack_blocks(const size_t max_blocks) const {
+    vector<SackBlock> blocks;
+    if (_engine == Engine::Bitmap) {
+        const uint64_t lo = _output.bytes_written();
+        uint64_t hi = _output.bytes_read() + _capacity;
+        while (blocks.size() < max_blocks && _unassembled_bytes > 0) {
+            const uint64_t end = _bitmap_last(lo, hi, true);
+            if (end == lo) {
+                break;
+            }
+            const uint64_t begin = _bitmap_last(lo, end, false);
+            blocks.push_back({begin, end});
+            hi = begin;
+        }
+        return blocks;
+    }
+
+    // 从最大的分片向前，合并首尾相接的分片
+    for (auto it = _pending.rbegin(); it != _pending.rend() && blocks.size() < max_blocks; ++it) {
+        const uint64_t end = it->first + it->second.size();
+        if (not blocks.empty() && blocks.back().begin == end) {
+            blocks.back().begin = it->first;
+        } else {
+            blocks.push_back({it->first, end});
+        }
+    }
+    // 最后一个块可能还能继续向前合并
+    if (max_blocks > 0 && blocks.size() == max_blocks) {
+        auto it = _pending.lower_bound(blocks.back().begin);
+        while (it != _pending.begin() && std::prev(it)->first + std::prev(it)->second.size() == blocks.back().begin) {
+            --it;
+            blocks.back().begin = it->first;
+        }
+    }
+    return blocks;
+}
+
+// 统计已收到但还未被写入的字符数
+size_t StreamReassembler::unassembled_bytes() const { return _unassembled_bytes; }
+
+bool StreamReassembler::empty() const { return _unassembled_bytes == 0; }
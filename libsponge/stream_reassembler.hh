@@ -1,32 +1,129 @@
 #ifndef SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 #define SPONGE_LIBSPONGE_STREAM_REASSEMBLER_HH
 
+#include "buffer.hh"
 #include "byte_stream.hh"
 
 #include <cstdint>
-#include <string>
+#include <limits>
 #include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 //! \brief A class that assembles a series of excerpts from a byte stream (possibly out of order,
 //! possibly overlapping) into an in-order byte stream.
 class StreamReassembler {
+  public:
+    //! How out-of-order bytes are held until they can be written
+    enum class Engine {
+        Map,     //!< non-overlapping intervals in a `std::map` (allocates per segment)
+        Bitmap,  //!< a capacity-sized ring at final offsets plus a presence bitmap (no allocation after construction)
+    };
+
+    //! What to give up when the pending fragments exceed the memory limit (Engine::Map only)
+    enum class EvictionPolicy {
+        DropFarthest,  //!< drop the fragment with the highest index (least likely to be needed soon)
+        DropNewest,    //!< drop the fragment that was just stored, then the farthest
+        Coalesce,      //!< copy runs of touching fragments into one, then drop the farthest
+    };
+
+    //! Memory accounting counters
+    struct MemoryStats {
+        size_t fragments{};       //!< fragments currently held
+        size_t payload_bytes{};   //!< bytes currently held (same as unassembled_bytes())
+        size_t overhead_bytes{};  //!< estimated bookkeeping cost of the fragments currently held
+        size_t evictions{};       //!< fragments dropped because of the memory limit, ever
+        size_t evicted_bytes{};   //!< bytes dropped because of the memory limit, ever
+        size_t coalesced{};       //!< fragments merged away by EvictionPolicy::Coalesce, ever
+    };
+
+    //! A received range of stream indices beyond the contiguous prefix, [begin, end)
+    struct SackBlock {
+        uint64_t begin{};
+        uint64_t end{};
+        bool operator==(const SackBlock &other) const { return begin == other.begin and end == other.end; }
+    };
+
+    //! Estimated cost of one pending fragment beyond its payload:
+    //! the map node (links, colour, key, Buffer) plus the shared storage control block and string header.
+    static constexpr size_t FRAGMENT_OVERHEAD = 4 * sizeof(void *) + sizeof(std::pair<const size_t, Buffer>) +
+                                                2 * sizeof(void *) + sizeof(std::string);
+
   private:
     // Your code here -- add private members as necessary.
 
     ByteStream _output;  //!< The reassembled in-order byte stream 重新组装的无序字节流
     size_t _capacity = 0;    //!< The maximum number of bytes 最大的字节数量
-    size_t read_ptr = 0;
-    size_t write_ptr = 0;
     size_t eof_index = 0;
     bool eof_f = false;
 
-    std::map<size_t,std::string> stream{};
+    //! Bytes waiting for a hole to be filled, keyed by stream index.
+    //! 区间互不重叠：插入时只与相邻区间比较并裁剪新数据
+    //! 区间保存为Buffer切片，裁剪时不拷贝
+    std::map<size_t, Buffer> _pending{};
+    size_t _unassembled_bytes = 0;  //!< total size of the Buffers in `_pending`
+
+    //! Clamp `view` to the window and write or store it; `owner`, if set, is the Buffer `view` points into
+    void _push(std::string_view view, const size_t index, const bool eof, const Buffer *owner);
+
+    //! Store [index, index + data.size()) in `_pending`, skipping bytes already held
+    //! \returns the new fragment, or `_pending.end()` if nothing was stored
+    std::map<size_t, Buffer>::iterator _insert_pending(Buffer data, size_t index);
+
+    size_t _memory_limit = std::numeric_limits<size_t>::max();
+    EvictionPolicy _eviction_policy = EvictionPolicy::DropFarthest;
+    size_t _evictions = 0;
+    size_t _evicted_bytes = 0;
+    size_t _coalesced = 0;
+
+    //! Evict or coalesce fragments until memory_usage() is within the limit
+    void _enforce_memory_limit(std::map<size_t, Buffer>::iterator newest);
+
+    //! Remove one fragment and count it as evicted
+    void _evict(std::map<size_t, Buffer>::iterator it);
+
+    //! Merge each run of touching fragments into a single one
+    void _coalesce();
+
+    //! Write any pending bytes that are now contiguous with the output stream
+    void _flush_pending();
+
+    Engine _engine;
+
+    //! \name Engine::Bitmap state
+    //! Byte `i` of the stream lives at `_ring[i % _capacity]`; bit `i % _capacity` of `_present` says whether it
+    //! has arrived. The window never spans more than `_capacity` bytes, so slots are never shared.
+    //!@{
+    std::vector<char> _ring{};
+    std::vector<uint64_t> _present{};
+
+    //! Copy `data` to its ring slots and mark them present
+    void _bitmap_insert(std::string_view data, size_t index);
+
+    //! Write the run of present bytes starting at `bytes_written()` and clear their bits
+    void _bitmap_flush();
+
+    //! Set bits [from, from + len) of the ring (wrapping); returns how many were newly set
+    size_t _bitmap_set(size_t from, size_t len);
+
+    //! Clear bits [from, from + len) of the ring (wrapping); returns how many were previously set
+    size_t _bitmap_clear(size_t from, size_t len);
+
+    //! Length of the run of set bits starting at ring slot `from`, at most `max`
+    size_t _bitmap_run(size_t from, size_t max) const;
+
+    //! One past the last stream index in [lo, hi) whose presence bit equals `present`, or `lo` if there is none
+    uint64_t _bitmap_last(uint64_t lo, uint64_t hi, bool present) const;
+    //!@}
 
   public:
     //! \brief Construct a `StreamReassembler` that will store up to `capacity` bytes.
     //! \note This capacity limits both the bytes that have been reassembled,
     //! and those that have not yet been reassembled.
-    StreamReassembler(const size_t capacity);
+    //! \param engine selects the data structure used for out-of-order bytes
+    StreamReassembler(const size_t capacity, const Engine engine = Engine::Map);
 
     //! \brief Receive a substring and write any newly contiguous bytes into the stream.
     //!
@@ -40,6 +137,11 @@ class StreamReassembler {
     //  data 的最后一个字节是否是整个数据流的最后一个字节
     void push_substring(const std::string &data, const uint64_t index, const bool eof);
 
+    //! \brief Receive a substring held in a Buffer (e.g. a TCP payload) without copying it.
+    //! \note Out-of-order bytes are retained as slices of `data`, so the whole underlying
+    //! storage stays alive until those bytes are assembled.
+    void push_substring(Buffer data, const uint64_t index, const bool eof);
+
     //! \name Access the reassembled byte stream
     //!@{
     const ByteStream &stream_out() const { return _output; }
@@ -52,6 +154,22 @@ class StreamReassembler {
     //! should only be counted once for the purpose of this function.
     size_t unassembled_bytes() const;
 
+    //! \brief Bound the memory used by pending fragments
+    //! \details Usage is payload bytes plus FRAGMENT_OVERHEAD per fragment. Evicted bytes are simply
+    //! forgotten, as if they had never arrived; the sender will retransmit them.
+    //! The limit is unlimited by default and has no effect on Engine::Bitmap, whose memory is fixed.
+    void set_memory_limit(const size_t bytes, const EvictionPolicy policy = EvictionPolicy::DropFarthest);
+
+    //! Estimated bytes of memory held by pending fragments
+    size_t memory_usage() const;
+
+    MemoryStats memory_stats() const;
+
+    //! \brief The highest `max_blocks` disjoint ranges held beyond the contiguous prefix, highest first
+    //! \details Suitable for RFC 2018 SACK blocks once translated to sequence numbers. Costs O(`max_blocks`)
+    //! map steps (plus any touching fragments), or word-at-a-time scans of the gaps for Engine::Bitmap.
+    std::vector<SackBlock> sack_blocks(const size_t max_blocks) const;
+
     //! \brief Is the internal state empty (other than the output stream)?
     //! \returns `true` if no substrings are waiting to be assembled
     bool empty() const;
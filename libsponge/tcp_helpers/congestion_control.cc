@@ -0,0 +1,171 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+void CongestionController::on_send(const uint64_t, const uint64_t, const size_t) {}
+
+unique_ptr<CongestionController> make_congestion_controller(const CongestionControl kind, const size_t mss) {
+    switch (kind) {
+        case CongestionControl::NewReno:
+            return make_unique<NewRenoController>(mss);
+        case CongestionControl::Cubic:
+            return make_unique<CubicController>(mss);
+        case CongestionControl::BBRLite:
+            return make_unique<BBRLiteController>(mss);
+        case CongestionControl::None:
+        default:
+            return nullptr;
+    }
+}
+
+void NewRenoController::on_ack(const uint64_t, const uint64_t, const size_t bytes_acked, const size_t) {
+    if (_cwnd < _ssthresh) {
+        // slow start: grow by the bytes acknowledged, at most one MSS per ACK
+        _cwnd += min(bytes_acked, _mss);
+        return;
+    }
+    // congestion avoidance: one MSS per cwnd of acknowledged data
+    _bytes_acked_in_ca += bytes_acked;
+    if (_bytes_acked_in_ca >= _cwnd) {
+        _bytes_acked_in_ca -= _cwnd;
+        _cwnd += _mss;
+    }
+}
+
+void NewRenoController::on_loss(const uint64_t, const size_t bytes_in_flight) {
+    _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+    _cwnd = _ssthresh;
+    _bytes_acked_in_ca = 0;
+}
+
+void NewRenoController::on_rto(const uint64_t, const size_t bytes_in_flight) {
+    _ssthresh = max(bytes_in_flight / 2, 2 * _mss);
+    _cwnd = _mss;
+    _bytes_acked_in_ca = 0;
+}
+
+void CubicController::_reduce(const uint64_t) {
+    const double segments = static_cast<double>(_cwnd) / _mss;
+    // fast convergence: release bandwidth sooner if the window is shrinking
+    _w_max = segments < _w_max ? segments * (1 + BETA) / 2 : segments;
+    _cwnd = max(static_cast<size_t>(segments * BETA * _mss), 2 * _mss);
+    _ssthresh = _cwnd;
+    _bytes_acked_in_ca = 0;
+    _epoch_start.reset();
+}
+
+void CubicController::on_ack(const uint64_t now, const uint64_t ackno, const size_t bytes_acked,
+                             const size_t bytes_in_flight) {
+    if (_cwnd < _ssthresh) {
+        NewRenoController::on_ack(now, ackno, bytes_acked, bytes_in_flight);
+        return;
+    }
+
+    const double segments = static_cast<double>(_cwnd) / _mss;
+    if (not _epoch_start.has_value()) {
+        _epoch_start = now;
+        if (segments < _w_max) {
+            _k = cbrt((_w_max - segments) / C);
+        } else {
+            _k = 0;
+            _w_max = segments;
+        }
+        _w_est = segments;
+    }
+
+    const double t = static_cast<double>(now - _epoch_start.value()) / 1000;
+    const double target = min(C * pow(t - _k, 3) + _w_max, 1.5 * segments);
+    const double acked_segments = static_cast<double>(bytes_acked) / _mss;
+
+    double next = segments;
+    if (target > segments) {
+        next += (target - segments) / segments * acked_segments;
+    }
+    // Reno-friendly region: never grow slower than standard TCP would
+    _w_est += 3 * (1 - BETA) / (1 + BETA) * acked_segments / segments;
+    _cwnd = max(_cwnd, static_cast<size_t>(max(next, _w_est) * _mss));
+}
+
+void CubicController::on_loss(const uint64_t now, const size_t) { _reduce(now); }
+
+void CubicController::on_rto(const uint64_t now, const size_t) {
+    _reduce(now);
+    _cwnd = _mss;
+}
+
+void BBRLiteController::on_send(const uint64_t now, const uint64_t seqno_end, const size_t) {
+    if (_sent.empty()) {
+        // nothing in flight: don't count the idle period against the delivery rate
+        _delivered_at = now;
+    }
+    _sent.push_back({seqno_end, now, _delivered, _delivered_at});
+}
+
+void BBRLiteController::on_ack(const uint64_t now, const uint64_t ackno, const size_t bytes_acked,
+                               const size_t) {
+    _after_rto = false;
+    _delivered += bytes_acked;
+    _delivered_at = now;
+
+    // the newest send covered by this ACK gives the samples
+    optional<SendRecord> newest{};
+    while (not _sent.empty() and _sent.front().seqno_end <= ackno) {
+        newest = _sent.front();
+        _sent.pop_front();
+    }
+
+    if (newest.has_value()) {
+        const uint64_t rtt = now - newest->sent_at;
+        if (not _min_rtt.has_value() or rtt <= _min_rtt.value() or now - _min_rtt_at > MIN_RTT_WINDOW) {
+            _min_rtt = rtt;
+            _min_rtt_at = now;
+        }
+
+        bool round_start = false;
+        if (newest->delivered >= _round_end_delivered) {
+            _round++;
+            _round_end_delivered = _delivered;
+            round_start = true;
+        }
+
+        const uint64_t interval = now - newest->delivered_at;
+        if (interval > 0) {
+            const double rate = static_cast<double>(_delivered - newest->delivered) / interval;
+            while (not _bw_samples.empty() and _bw_samples.back().bytes_per_ms <= rate) {
+                _bw_samples.pop_back();
+            }
+            _bw_samples.push_back({rate, _round});
+        }
+        while (not _bw_samples.empty() and _bw_samples.front().round + BW_WINDOW_ROUNDS < _round) {
+            _bw_samples.pop_front();
+        }
+
+        // leave startup once bandwidth stops growing by 25% for three rounds
+        if (_startup and round_start and bottleneck_bandwidth() > 0) {
+            if (bottleneck_bandwidth() >= _full_bw * 1.25) {
+                _full_bw = bottleneck_bandwidth();
+                _full_bw_rounds = 0;
+            } else if (++_full_bw_rounds >= 3) {
+                _startup = false;
+            }
+        }
+    }
+
+    const double bw = bottleneck_bandwidth();
+    if (_startup or bw == 0 or not _min_rtt.has_value()) {
+        _cwnd += bytes_acked;
+    } else {
+        const double bdp = bw * max<uint64_t>(_min_rtt.value(), 1);
+        _cwnd = min(_cwnd + bytes_acked, static_cast<size_t>(CWND_GAIN * bdp));
+    }
+    _cwnd = max(_cwnd, 4 * _mss);
+}
+
+void BBRLiteController::on_rto(const uint64_t, const size_t) {
+    // samples for segments sent before the timeout would be ambiguous
+    _sent.clear();
+    _after_rto = true;
+}
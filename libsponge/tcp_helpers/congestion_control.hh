@@ -0,0 +1,164 @@
+#ifndef SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+#define SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+
+//! Which congestion controller a TCPSender uses
+enum class CongestionControl {
+    None,     //!< no congestion window: send whatever the receiver's window allows
+    NewReno,  //!< [RFC 5681](\ref rfc::rfc5681) slow start and congestion avoidance
+    Cubic,    //!< [RFC 8312](\ref rfc::rfc8312) CUBIC window growth
+    BBRLite,  //!< a simplified delivery-rate model in the spirit of BBR
+};
+
+//! \brief Interface between a TCPSender and a congestion control algorithm
+//! \details All times are in milliseconds on the sender's clock (the sum of the `tick()` arguments);
+//! all sizes are in bytes of sequence space. The sender calls the hooks and never sends more than
+//! cwnd() bytes beyond the cumulative ackno.
+class CongestionController {
+  protected:
+    size_t _mss;  //!< maximum segment size
+
+  public:
+    explicit CongestionController(const size_t mss) : _mss(mss) {}
+    virtual ~CongestionController() = default;
+
+    //! New data occupying sequence numbers up to (not including) `seqno_end` was sent
+    virtual void on_send(const uint64_t now, const uint64_t seqno_end, const size_t bytes_in_flight);
+
+    //! The cumulative ackno advanced to `ackno`, acknowledging `bytes_acked` new bytes
+    virtual void on_ack(const uint64_t now, const uint64_t ackno, const size_t bytes_acked,
+                        const size_t bytes_in_flight) = 0;
+
+    //! Loss was detected without a timeout (e.g. duplicate ACKs or SACK)
+    virtual void on_loss(const uint64_t now, const size_t bytes_in_flight) = 0;
+
+    //! The retransmission timer expired
+    virtual void on_rto(const uint64_t now, const size_t bytes_in_flight) = 0;
+
+    //! The congestion window, in bytes
+    virtual size_t cwnd() const = 0;
+
+    //! The slow start threshold, in bytes (SIZE_MAX if not applicable)
+    virtual size_t ssthresh() const { return SIZE_MAX; }
+
+    //! Short name for logs
+    virtual std::string name() const = 0;
+};
+
+//! \brief Construct the controller selected by `kind`
+//! \returns nullptr for CongestionControl::None
+std::unique_ptr<CongestionController> make_congestion_controller(const CongestionControl kind, const size_t mss);
+
+//! \brief NewReno: slow start, then one MSS per window of acknowledged data; halve on loss
+class NewRenoController : public CongestionController {
+  protected:
+    size_t _cwnd;
+    size_t _ssthresh = SIZE_MAX;
+    size_t _bytes_acked_in_ca = 0;  //!< acknowledged bytes not yet turned into window growth
+
+  public:
+    static constexpr size_t INITIAL_WINDOW_SEGMENTS = 10;  //!< [RFC 6928](\ref rfc::rfc6928) initial window
+
+    explicit NewRenoController(const size_t mss) : CongestionController(mss), _cwnd(INITIAL_WINDOW_SEGMENTS * mss) {}
+
+    void on_ack(const uint64_t now, const uint64_t ackno, const size_t bytes_acked,
+                const size_t bytes_in_flight) override;
+    void on_loss(const uint64_t now, const size_t bytes_in_flight) override;
+    void on_rto(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override { return _cwnd; }
+    size_t ssthresh() const override { return _ssthresh; }
+    std::string name() const override { return "newreno"; }
+};
+
+//! \brief CUBIC: after a loss the window follows a cubic curve in time back to (and past) its old maximum
+class CubicController : public NewRenoController {
+    static constexpr double C = 0.4;     //!< scaling constant, in segments per second cubed
+    static constexpr double BETA = 0.7;  //!< multiplicative decrease factor
+
+    double _w_max = 0;                       //!< window before the last reduction, in segments
+    double _k = 0;                           //!< seconds the cubic curve takes to return to `_w_max`
+    double _w_est = 0;                       //!< Reno-friendly estimate, in segments
+    std::optional<uint64_t> _epoch_start{};  //!< time congestion avoidance (re)started
+
+    void _reduce(const uint64_t now);
+
+  public:
+    explicit CubicController(const size_t mss) : NewRenoController(mss) {}
+
+    void on_ack(const uint64_t now, const uint64_t ackno, const size_t bytes_acked,
+                const size_t bytes_in_flight) override;
+    void on_loss(const uint64_t now, const size_t bytes_in_flight) override;
+    void on_rto(const uint64_t now, const size_t bytes_in_flight) override;
+    std::string name() const override { return "cubic"; }
+};
+
+//! \brief BBR-lite: size the window from the measured bottleneck bandwidth and minimum RTT
+//! \details Each ACK yields an RTT sample and a delivery-rate sample for the newest acknowledged send.
+//! The window is CWND_GAIN times the estimated bandwidth-delay product. During startup the window grows
+//! by every acknowledged byte instead, until the bandwidth estimate stops growing by 25% for three rounds.
+//! Loss does not shrink the window; a timeout does, until the next ACK.
+class BBRLiteController : public CongestionController {
+  public:
+    static constexpr double CWND_GAIN = 2.0;
+    static constexpr uint64_t MIN_RTT_WINDOW = 10000;  //!< ms a min-RTT sample stays valid
+    static constexpr unsigned BW_WINDOW_ROUNDS = 10;   //!< rounds a bandwidth sample stays valid
+
+  private:
+    struct SendRecord {
+        uint64_t seqno_end;
+        uint64_t sent_at;
+        uint64_t delivered;     //!< total delivered bytes when this was sent
+        uint64_t delivered_at;  //!< time `delivered` was last updated when this was sent
+    };
+    std::deque<SendRecord> _sent{};
+
+    struct BandwidthSample {
+        double bytes_per_ms;
+        uint64_t round;
+    };
+    std::deque<BandwidthSample> _bw_samples{};  //!< monotonically decreasing max-filter
+
+    uint64_t _delivered = 0;
+    uint64_t _delivered_at = 0;
+    uint64_t _round = 0;
+    uint64_t _round_end_delivered = 0;  //!< a new round starts once this much has been delivered
+
+    std::optional<uint64_t> _min_rtt{};
+    uint64_t _min_rtt_at = 0;
+
+    bool _startup = true;
+    double _full_bw = 0;
+    unsigned _full_bw_rounds = 0;
+
+    bool _after_rto = false;
+    size_t _cwnd;
+
+  public:
+    explicit BBRLiteController(const size_t mss)
+        : CongestionController(mss), _cwnd(NewRenoController::INITIAL_WINDOW_SEGMENTS * mss) {}
+
+    void on_send(const uint64_t now, const uint64_t seqno_end, const size_t bytes_in_flight) override;
+    void on_ack(const uint64_t now, const uint64_t ackno, const size_t bytes_acked,
+                const size_t bytes_in_flight) override;
+    void on_loss(const uint64_t, const size_t) override {}
+    void on_rto(const uint64_t now, const size_t bytes_in_flight) override;
+    size_t cwnd() const override { return _after_rto ? _mss : _cwnd; }
+    std::string name() const override { return "bbr-lite"; }
+
+    //! Estimated bottleneck bandwidth, in bytes per millisecond (0 before the first sample)
+    double bottleneck_bandwidth() const { return _bw_samples.empty() ? 0 : _bw_samples.front().bytes_per_ms; }
+
+    //! Smallest recent RTT sample, in milliseconds
+    std::optional<uint64_t> min_rtt() const { return _min_rtt; }
+
+    //! Still in the startup phase?
+    bool in_startup() const { return _startup; }
+};
+
+#endif  // SPONGE_LIBSPONGE_CONGESTION_CONTROL_HH
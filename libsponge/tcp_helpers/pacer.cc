@@ -0,0 +1,29 @@
+#include "pacer.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+void Pacer::advance(const uint64_t ms) {
+    if (_rate == 0) {
+        _tokens = _burst;
+        return;
+    }
+    _tokens = min(_capacity(), _tokens + _rate * static_cast<double>(ms));
+}
+
+void Pacer::consume(const size_t bytes) {
+    if (_rate == 0) {
+        return;
+    }
+    _tokens -= static_cast<double>(bytes);
+}
+
+uint64_t Pacer::time_until_ready() const {
+    if (ready()) {
+        return 0;
+    }
+    // the first millisecond that leaves a positive balance
+    return static_cast<uint64_t>(floor(-_tokens / _rate)) + 1;
+}
@@ -0,0 +1,42 @@
+#ifndef SPONGE_LIBSPONGE_PACER_HH
+#define SPONGE_LIBSPONGE_PACER_HH
+
+#include <cstddef>
+#include <cstdint>
+
+//! \brief A token bucket that spaces transmissions out at a given rate
+//! \details Tokens are bytes. A transmission is allowed whenever the bucket holds any tokens and may
+//! overdraw it; the debt is repaid before the next transmission. The bucket holds at most `burst` bytes,
+//! or one millisecond's worth at the current rate if that is more, so the millisecond clock never
+//! limits throughput below the rate. A rate of zero means "unpaced": everything may be sent at once.
+class Pacer {
+    double _rate = 0;   //!< bytes per millisecond
+    double _burst;      //!< bucket capacity, in bytes
+    double _tokens;     //!< current fill; negative after an overdraft
+
+    double _capacity() const { return _burst > _rate ? _burst : _rate; }
+
+  public:
+    //! \param[in] burst the most bytes that may leave back to back after an idle period
+    explicit Pacer(const size_t burst) : _burst(static_cast<double>(burst)), _tokens(static_cast<double>(burst)) {}
+
+    //! Set the rate, in bytes per millisecond (0 to stop pacing)
+    void set_rate(const double bytes_per_ms) { _rate = bytes_per_ms > 0 ? bytes_per_ms : 0; }
+
+    //! The rate, in bytes per millisecond
+    double rate() const { return _rate; }
+
+    //! Refill the bucket for `ms` elapsed milliseconds
+    void advance(const uint64_t ms);
+
+    //! May a transmission go out now?
+    bool ready() const { return _rate == 0 or _tokens > 0; }
+
+    //! Account for `bytes` transmitted
+    void consume(const size_t bytes);
+
+    //! Milliseconds until ready() becomes true (0 if it already is)
+    uint64_t time_until_ready() const;
+};
+
+#endif  // SPONGE_LIBSPONGE_PACER_HH
@@ -0,0 +1,52 @@
+#include "segment_ring.hh"
+
+#include "util.hh"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+SegmentRing::SegmentRing(const size_t capacity) : _slots(capacity == 0 ? 0 : round_up_to_power_of_two(capacity)) {}
+
+void SegmentRing::_grow() {
+    vector<TCPSegment> slots(max(MIN_CAPACITY, _slots.size() * 2));
+    for (size_t i = 0; i < _size; i++) {
+        slots[i] = move(_slots[(_head + i) & _mask()]);
+    }
+    _slots = move(slots);
+    _head = 0;
+}
+
+void SegmentRing::push(const TCPSegment &seg) {
+    if (_size == _slots.size()) {
+        _grow();
+    }
+    _slots[(_head + _size) & _mask()] = seg;
+    _size++;
+}
+
+void SegmentRing::push(TCPSegment &&seg) {
+    if (_size == _slots.size()) {
+        _grow();
+    }
+    _slots[(_head + _size) & _mask()] = move(seg);
+    _size++;
+}
+
+void SegmentRing::pop() {
+    _slots[_head].payload() = Buffer{};
+    _head = (_head + 1) & _mask();
+    _size--;
+}
+
+size_t SegmentRing::drain(TCPSegment *out, const size_t max) {
+    const size_t count = min(max, _size);
+    for (size_t i = 0; i < count; i++) {
+        out[i] = move(_slots[_head]);
+        _slots[_head].payload() = Buffer{};
+        _head = (_head + 1) & _mask();
+    }
+    _size -= count;
+    return count;
+}
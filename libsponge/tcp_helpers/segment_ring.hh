@@ -0,0 +1,51 @@
+#ifndef SPONGE_LIBSPONGE_SEGMENT_RING_HH
+#define SPONGE_LIBSPONGE_SEGMENT_RING_HH
+
+#include "tcp_segment.hh"
+
+#include <cstddef>
+#include <vector>
+
+//! \brief A FIFO of TCPSegments backed by a ring of preconstructed slots
+//! \details Offers the subset of the std::queue interface that callers of segments_out() use, so
+//! single-segment code keeps working, plus drain() to hand over a batch at once. The ring
+//! allocates nothing until the first push, then starts at MIN_CAPACITY slots and doubles when
+//! full, so pushing and popping stop allocating once it has grown to the working set.
+class SegmentRing {
+    std::vector<TCPSegment> _slots;  //!< a power of two in size, or empty
+    size_t _head = 0;  //!< index of the oldest segment
+    size_t _size = 0;
+
+    size_t _mask() const { return _slots.size() - 1; }
+    void _grow();
+
+  public:
+    static constexpr size_t MIN_CAPACITY = 4;  //!< Slots constructed by the first push into an empty ring
+
+    //! \param[in] capacity slots to construct up front (rounded up to a power of two), or 0 to wait for
+    //! the first push
+    explicit SegmentRing(const size_t capacity = 0);
+
+    //! \name std::queue-compatible interface
+    //!@{
+    bool empty() const { return _size == 0; }
+    size_t size() const { return _size; }
+    TCPSegment &front() { return _slots[_head]; }
+    const TCPSegment &front() const { return _slots[_head]; }
+    TCPSegment &back() { return _slots[(_head + _size - 1) & _mask()]; }
+    const TCPSegment &back() const { return _slots[(_head + _size - 1) & _mask()]; }
+    void push(const TCPSegment &seg);
+    void push(TCPSegment &&seg);
+    //! \note Releases the popped segment's payload, so the ring never keeps stream data alive
+    void pop();
+    //!@}
+
+    //! \brief Move up to `max` segments, oldest first, into `out`
+    //! \returns the number of segments moved
+    size_t drain(TCPSegment *out, const size_t max);
+
+    //! \brief Number of preconstructed slots
+    size_t capacity() const { return _slots.size(); }
+};
+
+#endif  // SPONGE_LIBSPONGE_SEGMENT_RING_HH
@@ -2,6 +2,7 @@
 #define SPONGE_LIBSPONGE_TCP_CONFIG_HH
 
 #include "address.hh"
+#include "congestion_control.hh"
 #include "wrapping_integers.hh"
 
 #include <cstddef>
@@ -15,11 +16,41 @@ class TCPConfig {
     static constexpr size_t MAX_PAYLOAD_SIZE = 1452;   //!< Max TCP payload that fits in either IPv4 or UDP datagram
     static constexpr uint16_t TIMEOUT_DFLT = 1000;     //!< Default re-transmit timeout is 1 second
     static constexpr unsigned MAX_RETX_ATTEMPTS = 8;   //!< Maximum re-transmit attempts before giving up
+    static constexpr uint16_t RTO_MIN_DFLT = 200;      //!< Default lower bound on an adaptive retransmit timeout
+    static constexpr uint16_t RTO_MAX_DFLT = 60000;    //!< Default upper bound on an adaptive retransmit timeout
+    static constexpr unsigned DUPACK_THRESHOLD = 3;    //!< Duplicate ACKs that trigger a fast retransmit
+    static constexpr size_t PACING_BURST = 2 * MAX_PAYLOAD_SIZE;  //!< Bytes a paced sender may send back to back
+    static constexpr uint16_t DELAYED_ACK_DFLT = 40;   //!< Default delayed-ACK timeout, in milliseconds
+    static constexpr size_t TSO_MAX_SEGMENTS = 45;     //!< Most wire segments in one super segment (under 64 KiB)
 
     uint16_t rt_timeout = TIMEOUT_DFLT;       //!< Initial value of the retransmission timeout, in milliseconds
     size_t recv_capacity = DEFAULT_CAPACITY;  //!< Receive capacity, in bytes
     size_t send_capacity = DEFAULT_CAPACITY;  //!< Sender capacity, in bytes
     std::optional<WrappingInt32> fixed_isn{};
+    bool sack = false;  //!< Offer and use selective acknowledgments ([RFC 2018](\ref rfc::rfc2018))
+    bool window_scaling = false;  //!< Offer and use window scaling ([RFC 7323](\ref rfc::rfc7323))
+    CongestionControl congestion_control = CongestionControl::None;  //!< Sender congestion control algorithm
+    bool adaptive_rto = false;  //!< Compute the retransmit timeout from measured RTTs ([RFC 6298](\ref rfc::rfc6298))
+    uint16_t rto_min = RTO_MIN_DFLT;  //!< Smallest adaptive retransmit timeout, in milliseconds
+    uint16_t rto_max = RTO_MAX_DFLT;  //!< Largest adaptive (or backed-off) retransmit timeout, in milliseconds
+    bool fast_retransmit = false;  //!< Fast retransmit and NewReno recovery ([RFC 6582](\ref rfc::rfc6582))
+    bool pacing = false;           //!< Space segments out over the RTT instead of sending a window at once
+    size_t pacing_rate = 0;        //!< Pacing rate in bytes per second, or 0 to derive it from the window and SRTT
+    bool nagle = false;            //!< Nagle ([RFC 896](\ref rfc::rfc896)): hold small segments while data is unacked
+    bool delayed_ack = false;      //!< Acknowledge every second full segment, or after delayed_ack_timeout
+    uint16_t delayed_ack_timeout = DELAYED_ACK_DFLT;  //!< Longest an ACK may be delayed, in milliseconds
+    bool repacketize = false;  //!< Trim partially acknowledged segments and coalesce small ones on retransmit
+    bool tso = false;          //!< Send super segments, cut into wire segments when serialized (see TCPSegment)
+
+    //! \brief The window scale shift to announce for `recv_capacity`
+    //! \returns the smallest shift (at most 14) that lets a 16-bit window field describe the whole capacity
+    uint8_t recv_window_scale() const {
+        uint8_t shift = 0;
+        while (shift < 14 and (recv_capacity >> shift) > UINT16_MAX) {
+            shift++;
+        }
+        return shift;
+    }
 };
 
 //! Config for classes derived from FdAdapter
@@ -37,8 +37,12 @@ ParseResult TCPHeader::parse(NetParser &p) {
         return ParseResult::HeaderTooShort;
     }
 
-    // skip any options or anything extra in the header
-    p.remove_prefix(doff * 4 - TCPHeader::LENGTH);
+    // parse the options we understand and skip the rest
+    if (doff > 5) {
+        options.parse(p, doff * 4 - TCPHeader::LENGTH);
+    } else {
+        options = TCPOptions{};
+    }
 
     if (p.error()) {
         return p.get_error();
@@ -72,7 +76,11 @@ string TCPHeader::serialize() const {
 
     NetUnparser::u16(ret, uptr);  // urgent pointer
 
-    ret.resize(4 * doff);  // expand header to advertised size
+    // options, as far as the advertised size allows
+    const size_t header_length = 4 * doff;
+    options.serialize(ret, header_length - ret.size());
+
+    ret.resize(header_length);  // expand header to advertised size (zero bytes are EOL)
 
     return ret;
 }
@@ -90,6 +98,7 @@ string TCPHeader::to_string() const {
        << "TCP winsize: " << +win << '\n'
        << "TCP cksum: " << +cksum << '\n'
        << "TCP uptr: " << +uptr << '\n';
+    ss << options.to_string();
     return ss.str();
 }
 
@@ -104,5 +113,5 @@ bool TCPHeader::operator==(const TCPHeader &other) const {
     // TODO(aozdemir) more complete check (right now we omit cksum, src, dst
     return seqno == other.seqno && ackno == other.ackno && doff == other.doff && urg == other.urg && ack == other.ack &&
            psh == other.psh && rst == other.rst && syn == other.syn && fin == other.fin && win == other.win &&
-           uptr == other.uptr;
+           uptr == other.uptr && options == other.options;
 }
@@ -2,12 +2,14 @@
 #define SPONGE_LIBSPONGE_TCP_HEADER_HH
 
 #include "parser.hh"
+#include "tcp_options.hh"
 #include "wrapping_integers.hh"
 
 //! \brief [TCP](\ref rfc::rfc793) segment header
-//! \note TCP options are not supported
+//! \note See TCPOptions for the options that are understood
 struct TCPHeader {
     static constexpr size_t LENGTH = 20;  //!< [TCP](\ref rfc::rfc793) header length, not including options
+    static constexpr uint8_t MAX_DOFF = 15;  //!< Largest data offset: 60 bytes of header including options
 
     //! \struct TCPHeader
     //! ~~~{.txt}
@@ -50,6 +52,17 @@ struct TCPHeader {
     uint16_t uptr = 0;          //!< urgent pointer
     //!@}
 
+    //! TCP options
+    //! \note Options are only serialized into the space given by `doff`; see fit_options().
+    TCPOptions options{};
+
+    //! Set `doff` to the smallest value that holds all of `options`
+    //! (at most 15, in which case the options that do not fit are dropped when serializing)
+    void fit_options() {
+        const size_t words = (LENGTH + options.length()) / 4;
+        doff = static_cast<uint8_t>(words > MAX_DOFF ? MAX_DOFF : words);
+    }
+
     //! Parse the TCP fields from the provided NetParser
     ParseResult parse(NetParser &p);
 
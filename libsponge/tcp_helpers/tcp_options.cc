@@ -0,0 +1,174 @@
+#include "tcp_options.hh"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+// option kinds and lengths from RFC 793, RFC 2018 and RFC 7323
+constexpr uint8_t OPT_EOL = 0;
+constexpr uint8_t OPT_NOP = 1;
+constexpr uint8_t OPT_MSS = 2;
+constexpr uint8_t OPT_WINDOW_SCALE = 3;
+constexpr uint8_t OPT_SACK_PERMITTED = 4;
+constexpr uint8_t OPT_SACK = 5;
+constexpr uint8_t OPT_TIMESTAMPS = 8;
+
+constexpr size_t MSS_LENGTH = 4;
+constexpr size_t WINDOW_SCALE_LENGTH = 3;
+constexpr size_t SACK_PERMITTED_LENGTH = 2;
+constexpr size_t TIMESTAMPS_LENGTH = 10;
+constexpr size_t SACK_BLOCK_LENGTH = 8;
+
+//! Space taken by an option of length `len` once padded with leading NOPs to a multiple of 4
+constexpr size_t aligned(const size_t len) { return (len + 3) / 4 * 4; }
+
+//! Append NOPs so that an option of length `len` ends on a 4-byte boundary
+void pad(string &out, const size_t len) { out.append(aligned(len) - len, static_cast<char>(OPT_NOP)); }
+}  // namespace
+
+TCPSackList::TCPSackList(initializer_list<TCPSackBlock> blocks) {
+    for (const auto &block : blocks) {
+        push_back(block);
+    }
+}
+
+bool TCPSackList::push_back(const TCPSackBlock &block) {
+    if (_size == MAX_BLOCKS) {
+        return false;
+    }
+    _blocks[_size++] = block;
+    return true;
+}
+
+bool TCPSackList::operator==(const TCPSackList &other) const {
+    return _size == other._size and equal(begin(), end(), other.begin());
+}
+
+//! \param[in,out] p is a NetParser positioned at the first option byte
+//! \param[in] length is the number of option bytes (4 * doff - 20)
+void TCPOptions::parse(NetParser &p, size_t length) {
+    *this = TCPOptions{};
+
+    while (length > 0 and not p.error()) {
+        const uint8_t kind = p.u8();
+        length--;
+        if (kind == OPT_EOL) {
+            break;
+        }
+        if (kind == OPT_NOP) {
+            continue;
+        }
+        if (length == 0) {
+            break;
+        }
+        const uint8_t len = p.u8();
+        length--;
+        if (len < 2 or len - 2u > length) {
+            break;  // malformed: ignore the rest of the options
+        }
+        const size_t body = len - 2u;
+        length -= body;
+
+        if (kind == OPT_MSS and len == MSS_LENGTH) {
+            mss = p.u16();
+        } else if (kind == OPT_WINDOW_SCALE and len == WINDOW_SCALE_LENGTH) {
+            window_scale = min(p.u8(), MAX_WINDOW_SCALE);
+        } else if (kind == OPT_SACK_PERMITTED and len == SACK_PERMITTED_LENGTH) {
+            sack_permitted = true;
+        } else if (kind == OPT_TIMESTAMPS and len == TIMESTAMPS_LENGTH) {
+            Timestamps ts;
+            ts.value = p.u32();
+            ts.echo_reply = p.u32();
+            timestamps = ts;
+        } else if (kind == OPT_SACK and body % SACK_BLOCK_LENGTH == 0) {
+            for (size_t i = 0; i < body / SACK_BLOCK_LENGTH; i++) {
+                const WrappingInt32 left{p.u32()};
+                const WrappingInt32 right{p.u32()};
+                sack.push_back({left, right});
+            }
+        } else {
+            p.remove_prefix(body);
+        }
+    }
+    p.remove_prefix(length);
+}
+
+size_t TCPOptions::serialize(string &out, const size_t room) const {
+    const size_t start = out.size();
+    const auto fits = [&](const size_t len) { return out.size() - start + aligned(len) <= room; };
+
+    if (mss.has_value() and fits(MSS_LENGTH)) {
+        pad(out, MSS_LENGTH);
+        NetUnparser::u8(out, OPT_MSS);
+        NetUnparser::u8(out, MSS_LENGTH);
+        NetUnparser::u16(out, mss.value());
+    }
+    if (window_scale.has_value() and fits(WINDOW_SCALE_LENGTH)) {
+        pad(out, WINDOW_SCALE_LENGTH);
+        NetUnparser::u8(out, OPT_WINDOW_SCALE);
+        NetUnparser::u8(out, WINDOW_SCALE_LENGTH);
+        NetUnparser::u8(out, window_scale.value());
+    }
+    if (sack_permitted and fits(SACK_PERMITTED_LENGTH)) {
+        pad(out, SACK_PERMITTED_LENGTH);
+        NetUnparser::u8(out, OPT_SACK_PERMITTED);
+        NetUnparser::u8(out, SACK_PERMITTED_LENGTH);
+    }
+    if (timestamps.has_value() and fits(TIMESTAMPS_LENGTH)) {
+        pad(out, TIMESTAMPS_LENGTH);
+        NetUnparser::u8(out, OPT_TIMESTAMPS);
+        NetUnparser::u8(out, TIMESTAMPS_LENGTH);
+        NetUnparser::u32(out, timestamps->value);
+        NetUnparser::u32(out, timestamps->echo_reply);
+    }
+    if (not sack.empty() and fits(2 + SACK_BLOCK_LENGTH)) {
+        const size_t left_over = room - (out.size() - start);
+        const size_t n = min(sack.size(), (left_over - aligned(2)) / SACK_BLOCK_LENGTH);
+        const size_t len = 2 + n * SACK_BLOCK_LENGTH;
+        pad(out, len);
+        NetUnparser::u8(out, OPT_SACK);
+        NetUnparser::u8(out, static_cast<uint8_t>(len));
+        for (size_t i = 0; i < n; i++) {
+            NetUnparser::u32(out, sack[i].left.raw_value());
+            NetUnparser::u32(out, sack[i].right.raw_value());
+        }
+    }
+    return out.size() - start;
+}
+
+size_t TCPOptions::length() const {
+    size_t len = 0;
+    len += mss.has_value() ? aligned(MSS_LENGTH) : 0;
+    len += window_scale.has_value() ? aligned(WINDOW_SCALE_LENGTH) : 0;
+    len += sack_permitted ? aligned(SACK_PERMITTED_LENGTH) : 0;
+    len += timestamps.has_value() ? aligned(TIMESTAMPS_LENGTH) : 0;
+    len += sack.empty() ? 0 : aligned(2 + SACK_BLOCK_LENGTH * sack.size());
+    return len;
+}
+
+string TCPOptions::to_string() const {
+    stringstream ss{};
+    if (mss.has_value()) {
+        ss << "TCP MSS: " << mss.value() << '\n';
+    }
+    if (window_scale.has_value()) {
+        ss << "TCP window scale: " << +window_scale.value() << '\n';
+    }
+    if (sack_permitted) {
+        ss << "TCP SACK permitted\n";
+    }
+    if (timestamps.has_value()) {
+        ss << "TCP timestamps: " << timestamps->value << " echo " << timestamps->echo_reply << '\n';
+    }
+    for (const auto &block : sack) {
+        ss << "TCP SACK block: " << block.left << " - " << block.right << '\n';
+    }
+    return ss.str();
+}
+
+bool TCPOptions::operator==(const TCPOptions &other) const {
+    return mss == other.mss and window_scale == other.window_scale and timestamps == other.timestamps and
+           sack_permitted == other.sack_permitted and sack == other.sack;
+}
@@ -0,0 +1,103 @@
+#ifndef SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+#define SPONGE_LIBSPONGE_TCP_OPTIONS_HH
+
+#include "parser.hh"
+#include "wrapping_integers.hh"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <string>
+
+//! \brief A [SACK](\ref rfc::rfc2018) block: the sequence numbers [left, right) have been received
+struct TCPSackBlock {
+    WrappingInt32 left{0};   //!< first sequence number of the block
+    WrappingInt32 right{0};  //!< sequence number immediately following the block
+
+    bool operator==(const TCPSackBlock &other) const { return left == other.left and right == other.right; }
+    bool operator!=(const TCPSackBlock &other) const { return not operator==(other); }
+};
+
+//! \brief The SACK blocks of one segment, stored inline (never allocates)
+class TCPSackList {
+  public:
+    static constexpr size_t MAX_BLOCKS = 4;  //!< Most SACK blocks that fit in the option space
+
+  private:
+    std::array<TCPSackBlock, MAX_BLOCKS> _blocks{};
+    size_t _size = 0;
+
+  public:
+    TCPSackList() = default;
+
+    //! \brief Construct from a list of blocks; blocks past MAX_BLOCKS are dropped
+    TCPSackList(std::initializer_list<TCPSackBlock> blocks);
+
+    //! \brief Append a block
+    //! \returns `false` (and drops the block) if the list is already full
+    bool push_back(const TCPSackBlock &block);
+
+    void clear() { _size = 0; }
+    size_t size() const { return _size; }
+    bool empty() const { return _size == 0; }
+
+    //! \name Iteration
+    //!@{
+    const TCPSackBlock *begin() const { return _blocks.data(); }
+    const TCPSackBlock *end() const { return _blocks.data() + _size; }
+    TCPSackBlock *begin() { return _blocks.data(); }
+    TCPSackBlock *end() { return _blocks.data() + _size; }
+    const TCPSackBlock &operator[](const size_t i) const { return _blocks[i]; }
+    //!@}
+
+    bool operator==(const TCPSackList &other) const;
+    bool operator!=(const TCPSackList &other) const { return not operator==(other); }
+};
+
+//! \brief The [TCP](\ref rfc::rfc793) options this implementation understands
+//! \details MSS ([RFC 793](\ref rfc::rfc793)), window scale and timestamps ([RFC 7323](\ref rfc::rfc7323)),
+//! and SACK-permitted and SACK ([RFC 2018](\ref rfc::rfc2018)). Unknown options are skipped when parsing.
+//! Everything is held inline, so parsing and copying never allocate.
+struct TCPOptions {
+    static constexpr uint8_t MAX_WINDOW_SCALE = 14;  //!< Largest shift allowed by RFC 7323
+
+    //! Timestamps option values
+    struct Timestamps {
+        uint32_t value = 0;       //!< TSval: the sender's clock when the segment was sent
+        uint32_t echo_reply = 0;  //!< TSecr: the most recent TSval received from the peer
+
+        bool operator==(const Timestamps &other) const {
+            return value == other.value and echo_reply == other.echo_reply;
+        }
+    };
+
+    std::optional<uint16_t> mss{};          //!< maximum segment size (SYN only)
+    std::optional<uint8_t> window_scale{};  //!< window scale shift count (SYN only)
+    std::optional<Timestamps> timestamps{};
+    bool sack_permitted = false;  //!< SACK-permitted (SYN only)
+    TCPSackList sack{};           //!< SACK blocks
+
+    //! \brief Parse `length` bytes of options from `p`
+    //! \note Malformed options end the option list; the remaining bytes are skipped.
+    void parse(NetParser &p, size_t length);
+
+    //! \brief Append as many options as fit in `room` bytes to `out`
+    //! \details Each option is preceded by NOPs so it stays 4-byte aligned; SACK blocks are truncated to fit.
+    //! \returns the number of bytes appended (a multiple of 4)
+    size_t serialize(std::string &out, const size_t room) const;
+
+    //! Bytes needed to serialize every option, a multiple of 4
+    size_t length() const;
+
+    //! Are there no options at all?
+    bool empty() const { return length() == 0; }
+
+    //! Human-readable list of the options present
+    std::string to_string() const;
+
+    bool operator==(const TCPOptions &other) const;
+};
+
+#endif  // SPONGE_LIBSPONGE_TCP_OPTIONS_HH
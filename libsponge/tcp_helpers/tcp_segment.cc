@@ -3,10 +3,64 @@
 #include "parser.hh"
 #include "util.hh"
 
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cstring>
+#include <stdexcept>
 #include <variant>
 
 using namespace std;
 
+namespace {
+//! Ones'-complement sum of `len` bytes as big-endian 16-bit words (`in` must start on an even offset of
+//! the segment), copying them to `out` on the way if `Copy`. Words are summed eight bytes at a time in
+//! host order and swapped once at the end ([RFC 1071](https://tools.ietf.org/html/rfc1071) 2(B)).
+template <bool Copy>
+uint32_t fold_words(char *out, const char *in, const size_t len) {
+    uint64_t sum = 0;
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w = 0;
+        memcpy(&w, in + i, 8);
+        if constexpr (Copy) {
+            memcpy(out + i, &w, 8);
+        }
+        sum += (w & 0xffff) + ((w >> 16) & 0xffff) + ((w >> 32) & 0xffff) + (w >> 48);
+    }
+    for (; i + 2 <= len; i += 2) {
+        uint16_t w = 0;
+        memcpy(&w, in + i, 2);
+        if constexpr (Copy) {
+            memcpy(out + i, &w, 2);
+        }
+        sum += w;
+    }
+    while (sum > 0xffff) {
+        sum = (sum >> 16) + (sum & 0xffff);
+    }
+    uint32_t ret = ntohs(static_cast<uint16_t>(sum));
+    if (i < len) {
+        if constexpr (Copy) {
+            out[i] = in[i];
+        }
+        ret += static_cast<uint32_t>(static_cast<uint8_t>(in[i])) << 8;
+    }
+    return ret;
+}
+
+uint32_t sum_words(const string_view data) { return fold_words<false>(nullptr, data.data(), data.size()); }
+
+void put_u16(char *out, const uint16_t val) {
+    out[0] = static_cast<char>(val >> 8);
+    out[1] = static_cast<char>(val);
+}
+
+void put_u32(char *out, const uint32_t val) {
+    put_u16(out, static_cast<uint16_t>(val >> 16));
+    put_u16(out + 2, static_cast<uint16_t>(val));
+}
+}  // namespace
+
 //! \param[in] buffer string/Buffer to be parsed
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
 ParseResult TCPSegment::parse(const Buffer buffer, const uint32_t datagram_layer_checksum) {
@@ -26,20 +80,132 @@ size_t TCPSegment::length_in_sequence_space() const {
     return payload().str().size() + (header().syn ? 1 : 0) + (header().fin ? 1 : 0);
 }
 
+size_t TCPSegment::_wire_segments() const {
+    if (_gso_size == 0 or _payload.size() <= _gso_size) {
+        return 1;
+    }
+    return (_payload.size() + _gso_size - 1) / _gso_size;
+}
+
+vector<TCPSegment> TCPSegment::split() const {
+    const size_t count = _wire_segments();
+    vector<TCPSegment> ret(count, *this);
+    uint32_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        TCPSegment &seg = ret[i];
+        seg._gso_size = 0;
+        if (count > 1) {
+            const size_t len = min(_gso_size, _payload.size() - offset);
+            seg._payload.remove_prefix(offset);
+            seg._payload.remove_suffix(_payload.size() - offset - len);
+            seg._header.seqno = i == 0 ? _header.seqno : _header.seqno + (_header.syn ? 1 : 0) + offset;
+            seg._header.syn = _header.syn and i == 0;
+            seg._header.fin = _header.fin and i == count - 1;
+            offset += len;
+        }
+    }
+    return ret;
+}
+
+//! \param[in] pseudo_header_sum pseudo-checksum from the lower-layer protocol, not counting the TCP length
+vector<BufferList> TCPSegment::serialize_split(const uint32_t pseudo_header_sum) const {
+    const size_t count = _wire_segments();
+    const size_t piece = count > 1 ? _gso_size : _payload.size();
+
+    // serialize the header once; each wire segment patches the seqno, flags and checksum
+    TCPHeader header_template = _header;
+    header_template.cksum = 0;
+    header_template.syn = false;
+    header_template.fin = false;
+    const string header_bytes = header_template.serialize();
+
+    vector<BufferList> ret;
+    ret.reserve(count);
+    uint32_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        const size_t len = min(piece, _payload.size() - offset);
+        Buffer payload = _payload;
+        payload.remove_prefix(offset);
+        payload.remove_suffix(_payload.size() - offset - len);
+
+        const bool syn = _header.syn and i == 0;
+        const bool fin = _header.fin and i == count - 1;
+        const uint32_t seqno = (_header.seqno + (i == 0 ? 0 : (_header.syn ? 1 : 0) + offset)).raw_value();
+
+        string header = header_bytes;
+        header[4] = static_cast<char>(seqno >> 24);
+        header[5] = static_cast<char>(seqno >> 16);
+        header[6] = static_cast<char>(seqno >> 8);
+        header[7] = static_cast<char>(seqno);
+        header[13] = static_cast<char>(header[13] | (syn ? 0b0000'0010 : 0) | (fin ? 0b0000'0001 : 0));
+
+        InternetChecksum check(pseudo_header_sum + static_cast<uint32_t>(header.size() + len) + sum_words(header) +
+                               sum_words(payload));
+        const uint16_t cksum = check.value();
+        header[16] = static_cast<char>(cksum >> 8);
+        header[17] = static_cast<char>(cksum);
+
+        BufferList out;
+        out.append(Buffer(move(header)));
+        out.append(move(payload));
+        ret.push_back(move(out));
+        offset += len;
+    }
+    return ret;
+}
+
 //! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
 BufferList TCPSegment::serialize(const uint32_t datagram_layer_checksum) const {
     TCPHeader header_out = _header;
     header_out.cksum = 0;
+    string header = header_out.serialize();
 
-    // calculate checksum -- taken over entire segment
-    InternetChecksum check(datagram_layer_checksum);
-    check.add(header_out.serialize());
-    check.add(_payload);
-    header_out.cksum = check.value();
+    // calculate checksum -- taken over entire segment -- and patch it into the serialized header
+    InternetChecksum check(datagram_layer_checksum + sum_words(header) + sum_words(_payload));
+    put_u16(header.data() + 16, check.value());
 
     BufferList ret;
-    ret.append(header_out.serialize());
+    ret.append(Buffer(move(header)));
     ret.append(_payload);
 
     return ret;
 }
+
+//! \param[out] out where to write the segment
+//! \param[in] room bytes available at `out`
+//! \param[in] datagram_layer_checksum pseudo-checksum from the lower-layer protocol
+size_t TCPSegment::serialize_into(char *out, const size_t room, const uint32_t datagram_layer_checksum) const {
+    if (_header.doff < 5) {
+        throw runtime_error("TCP header too short");
+    }
+    const size_t header_length = 4 * _header.doff;
+    const size_t length = header_length + _payload.size();
+    if (length > room) {
+        throw runtime_error("TCP segment of " + to_string(length) + " bytes does not fit in " + to_string(room));
+    }
+
+    if (header_length == TCPHeader::LENGTH) {
+        put_u16(out, _header.sport);
+        put_u16(out + 2, _header.dport);
+        put_u32(out + 4, _header.seqno.raw_value());
+        put_u32(out + 8, _header.ackno.raw_value());
+        out[12] = static_cast<char>(_header.doff << 4);
+        out[13] = static_cast<char>((_header.urg ? 0b0010'0000 : 0) | (_header.ack ? 0b0001'0000 : 0) |
+                                    (_header.psh ? 0b0000'1000 : 0) | (_header.rst ? 0b0000'0100 : 0) |
+                                    (_header.syn ? 0b0000'0010 : 0) | (_header.fin ? 0b0000'0001 : 0));
+        put_u16(out + 14, _header.win);
+        put_u16(out + 18, _header.uptr);
+    } else {
+        // options are rare (SYN, SACK): let TCPHeader lay them out
+        const string header = _header.serialize();
+        memcpy(out, header.data(), header_length);
+    }
+    put_u16(out + 16, 0);
+
+    const uint32_t header_sum = fold_words<false>(nullptr, out, header_length);
+    const uint32_t payload_sum = fold_words<true>(out + header_length, _payload.str().data(), _payload.size());
+    InternetChecksum check(datagram_layer_checksum + header_sum + payload_sum);
+    put_u16(out + 16, check.value());
+
+    return length;
+}
@@ -5,12 +5,17 @@
 #include "tcp_header.hh"
 
 #include <cstdint>
+#include <vector>
 
 //! \brief [TCP](\ref rfc::rfc793) segment
 class TCPSegment {
   private:
     TCPHeader _header{};
     Buffer _payload{};
+    size_t _gso_size{};  //!< payload bytes per wire segment if this is a super segment, else 0
+
+    //! The number of wire segments this segment stands for
+    size_t _wire_segments() const;
 
   public:
     //! \brief Parse the segment from a string
@@ -21,6 +26,13 @@ class TCPSegment {
     // 将段解析为字符串
     BufferList serialize(const uint32_t datagram_layer_checksum = 0) const;
 
+    //! \brief Serialize the segment into a caller-provided buffer
+    //! \details Writes the header in place and copies the payload after it, folding the checksum in as
+    //! it goes. Allocates nothing unless the header carries options. A super segment is written whole.
+    //! \returns the number of bytes written
+    //! \throws std::runtime_error if the segment needs more than `room` bytes
+    size_t serialize_into(char *out, const size_t room, const uint32_t datagram_layer_checksum = 0) const;
+
     //! \name Accessors
     //!@{
     const TCPHeader &header() const { return _header; }
@@ -30,6 +42,27 @@ class TCPSegment {
     Buffer &payload() { return _payload; }
     //!@}
 
+    //! \name Super segments (TSO/GSO)
+    //! A super segment carries more payload than fits in one wire segment, under a single header. It is cut
+    //! into wire segments of gso_size() payload bytes when serialized: each gets its own seqno and
+    //! checksum, SYN stays on the first, FIN moves to the last, and all share the payload's storage.
+    //!@{
+
+    //! \brief Payload bytes per wire segment (0 for an ordinary segment)
+    size_t gso_size() const { return _gso_size; }
+
+    //! \brief Mark this as a super segment to be cut into wire segments of `gso_size` payload bytes
+    void set_gso_size(const size_t gso_size) { _gso_size = gso_size; }
+
+    //! \brief Cut into wire segments (a single copy of this segment unless it is a super segment)
+    std::vector<TCPSegment> split() const;
+
+    //! \brief Serialize each wire segment in one pass, sharing one serialized header template
+    //! \param[in] pseudo_header_sum the lower layer's pseudo-header sum *without* the TCP length,
+    //! which differs between wire segments and is added here
+    std::vector<BufferList> serialize_split(const uint32_t pseudo_header_sum = 0) const;
+    //!@}
+
     //! \brief Segment's length in sequence space
     //! \note Equal to payload length plus one byte if SYN is set, plus one byte if FIN is set
     size_t length_in_sequence_space() const;
@@ -1,5 +1,7 @@
 #include "tcp_receiver.hh"
 
+#include <algorithm>
+
 // Dummy implementation of a TCP receiver
 
 // For Lab 2, please replace with a real implementation that passes the
@@ -16,6 +18,8 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
             return;
         }
         _syn = true;
+        _sack_ok = _sack_enabled && seg.header().options.sack_permitted;
+        _wscale_ok = _wscale_enabled && seg.header().options.window_scale.has_value();
         _isn = seg.header().seqno.raw_value();
         _begin = seg.header().seqno.raw_value();
         
@@ -30,10 +34,18 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
     size_t len = seg.length_in_sequence_space() - seg.header().syn - seg.header().fin;
     size_t index = unwrap(WrappingInt32(_begin) , WrappingInt32(_isn), _checkp);
     if(((index + len) < _checkp) || (index) >= (_checkp + window_size())){
+        _schedule_ack(true, 0);
         return;
     }
-    _reassembler.push_substring(seg.payload().copy(),index,seg.header().fin);      
+    const bool had_holes = unassembled_bytes() > 0;
+    const bool out_of_order = index > _checkp;
+    _reassembler.push_substring(seg.payload(),index,seg.header().fin);      
     _checkp = stream_out().bytes_written();
+    _schedule_ack(out_of_order || had_holes || seg.header().syn || seg.header().fin, len);
+    // 记录最近一次乱序到达的数据位置
+    if(len > 0 && index > _checkp){
+        _last_ooo_index = index;
+    }
 
     if(stream_out().input_ended()){
         ack = wrap((_checkp+2),WrappingInt32(_isn));
@@ -46,6 +58,57 @@ void TCPReceiver::segment_received(const TCPSegment &seg) {
     return;
 }
 
+void TCPReceiver::_schedule_ack(const bool immediate, const size_t len) {
+    _unacked_bytes += len;
+    if(!_delayed_ack || immediate || _unacked_bytes >= 2 * TCPConfig::MAX_PAYLOAD_SIZE){
+        _ack_due = true;
+        return;
+    }
+    // 第一个未确认的段启动计时器
+    if(!_ack_timer.has_value()){
+        _ack_timer = _delayed_ack_timeout;
+    }
+}
+
+void TCPReceiver::ack_sent() {
+    _ack_due = false;
+    _unacked_bytes = 0;
+    _ack_timer.reset();
+}
+
+void TCPReceiver::tick(const size_t ms_since_last_tick) {
+    if(!_ack_timer.has_value() || _ack_due){
+        return;
+    }
+    if(*_ack_timer <= ms_since_last_tick){
+        _ack_due = true;
+        _ack_timer.reset();
+    }else{
+        *_ack_timer -= ms_since_last_tick;
+    }
+}
+
 optional<WrappingInt32> TCPReceiver::ackno() const { return ack; }
 
+TCPSackList TCPReceiver::sack_blocks() const {
+    TCPSackList blocks;
+    if(!_sack_ok || !ack.has_value()){
+        return blocks;
+    }
+    // 流索引 + 1(SYN) = 绝对序号
+    for(const auto &range : _reassembler.sack_blocks(TCPSackList::MAX_BLOCKS)){
+        blocks.push_back({wrap(range.begin + 1, WrappingInt32(_isn)), wrap(range.end + 1, WrappingInt32(_isn))});
+        // 包含最近到达数据的块放在最前面
+        if(_last_ooo_index.has_value() && range.begin <= *_last_ooo_index && *_last_ooo_index < range.end){
+            rotate(blocks.begin(), blocks.end() - 1, blocks.end());
+        }
+    }
+    return blocks;
+}
+
 size_t TCPReceiver::window_size() const { return {stream_out().remaining_capacity()}; }
+
+uint16_t TCPReceiver::window_advertisement() const {
+    const size_t scaled = window_size() >> (_wscale_ok ? _rcv_wscale : 0);
+    return static_cast<uint16_t>(min<size_t>(scaled, UINT16_MAX));
+}
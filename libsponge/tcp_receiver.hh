@@ -3,6 +3,7 @@
 
 #include "byte_stream.hh"
 #include "stream_reassembler.hh"
+#include "tcp_config.hh"
 #include "tcp_segment.hh"
 #include "wrapping_integers.hh"
 
@@ -27,6 +28,28 @@ class TCPReceiver {
 
     std::optional<WrappingInt32> ack{};
 
+    //! SACK is enabled locally and the peer's SYN offered it
+    bool _sack_enabled = false;
+    bool _sack_ok = false;
+
+    //! window scaling ([RFC 7323](\ref rfc::rfc7323)): the shift we announce, used once the peer's SYN offered it
+    bool _wscale_enabled = false;
+    uint8_t _rcv_wscale = 0;
+    bool _wscale_ok = false;
+    //! stream index of the most recent out-of-order payload, reported first in SACK blocks
+    std::optional<uint64_t> _last_ooo_index{};
+
+    //! delayed ACK: bytes received in order since the last ACK, and the time left before one is due
+    // 乱序、填补空洞、SYN/FIN和窗口外的段立即确认
+    bool _delayed_ack = false;
+    size_t _delayed_ack_timeout = TCPConfig::DELAYED_ACK_DFLT;
+    size_t _unacked_bytes = 0;
+    std::optional<size_t> _ack_timer{};
+    bool _ack_due = false;
+
+    //! Decide whether a segment that was just received needs an ACK now or may wait
+    void _schedule_ack(const bool immediate, const size_t len);
+
   public:
     //! \brief Construct a TCP receiver
     //!
@@ -34,6 +57,17 @@ class TCPReceiver {
     //!                 store in its buffers at any give time.
     TCPReceiver(const size_t capacity) : _reassembler(capacity), _capacity(capacity) {}
 
+    //! \brief Construct a TCP receiver from the receiver fields of a TCPConfig
+    //! (recv_capacity, sack, window_scaling, delayed_ack, delayed_ack_timeout)
+    explicit TCPReceiver(const TCPConfig &config)
+        : _reassembler(config.recv_capacity)
+        , _capacity(config.recv_capacity)
+        , _sack_enabled(config.sack)
+        , _wscale_enabled(config.window_scaling)
+        , _rcv_wscale(config.recv_window_scale())
+        , _delayed_ack(config.delayed_ack)
+        , _delayed_ack_timeout(config.delayed_ack_timeout) {}
+
     //! \name Accessors to provide feedback to the remote TCPSender
     //!@{
     
@@ -57,8 +91,35 @@ class TCPReceiver {
     //! accepted by the receiver) and (b) the sequence number of the
     //! beginning of the window (the ackno).
     size_t window_size() const;
+
+    //! \brief The value for the 16-bit `win` field of a non-SYN segment sent to the peer
+    //! \details window_size() shifted right by our window scale once both sides offered scaling,
+    //! and clamped to 65535 either way.
+    uint16_t window_advertisement() const;
+
+    //! \brief The window scale shift to announce in our SYN, if window scaling is enabled
+    std::optional<uint8_t> window_scale() const {
+        return _wscale_enabled ? std::optional<uint8_t>{_rcv_wscale} : std::nullopt;
+    }
+
+    //! \brief The SACK blocks that should be sent to the peer
+    //! \returns empty unless both sides offered SACK; otherwise up to TCPSackList::MAX_BLOCKS blocks,
+    //! the one holding the most recently received out-of-order data first ([RFC 2018](\ref rfc::rfc2018))
+    TCPSackList sack_blocks() const;
+
+    //! \brief Should an ACK be sent now?
+    //! \details Without delayed ACK, after every segment received. With it, after every second
+    //! full-size segment, after any out-of-order, hole-filling, SYN, FIN or unacceptable segment,
+    //! or once delayed_ack_timeout has passed since the first unacknowledged segment.
+    bool ack_due() const { return _ack_due; }
     //!@}
 
+    //! \brief Tell the receiver an ACK with the current ackno and window was sent
+    void ack_sent();
+
+    //! \brief Notifies the TCPReceiver of the passage of time (runs the delayed-ACK timer)
+    void tick(const size_t ms_since_last_tick);
+
     //! \brief number of bytes stored but not yet reassembled
     size_t unassembled_bytes() const { return _reassembler.unassembled_bytes(); }
 
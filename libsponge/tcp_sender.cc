@@ -2,6 +2,7 @@
 
 #include "tcp_config.hh"
 
+#include <algorithm>
 #include <random>
 
 // Dummy implementation of a TCP sender
@@ -19,29 +20,113 @@ TCPSender::TCPSender(const size_t capacity, const uint16_t retx_timeout, const s
     : _isn(fixed_isn.value_or(WrappingInt32{random_device()()}))
     , _initial_retransmission_timeout{retx_timeout}
     , _rto_base{retx_timeout}
+    , _rto_estimate{retx_timeout}
     , _stream(capacity) 
     , RTO{retx_timeout}{}
 
-uint64_t TCPSender::bytes_in_flight() const { return {_next_seqno - ack_s}; }
+TCPSender::TCPSender(const TCPConfig &config) : TCPSender(config.send_capacity, config.rt_timeout, config.fixed_isn) {
+    _sack_enabled = config.sack;
+    _wscale_enabled = config.window_scaling;
+    _rcv_wscale = config.recv_window_scale();
+    _cc = make_congestion_controller(config.congestion_control, TCPConfig::MAX_PAYLOAD_SIZE);
+    _adaptive_rto = config.adaptive_rto;
+    _rto_min = config.rto_min;
+    _rto_max = max(config.rto_max, config.rto_min);
+    _fast_retransmit = config.fast_retransmit;
+    _pacing = config.pacing;
+    if(_pacing){
+        _paced = make_unique<SegmentRing>();
+    }
+    _pacing_rate = config.pacing_rate;
+    _update_pacing_rate();
+    _nagle = config.nagle;
+    _repacketize = config.repacketize;
+    _tso = config.tso;
+}
+
+TCPSender::~TCPSender() {
+    if(_wheel){
+        _wheel->cancel(_wheel_timer);
+    }
+}
+
+void TCPSender::attach_timer_wheel(TimerWheel &wheel) {
+    if(_wheel){
+        _wheel->cancel(_wheel_timer);
+    }
+    _wheel = &wheel;
+    _wheel_synced = wheel.now();
+    _arm_wheel();
+}
+
+void TCPSender::_sync_wheel() {
+    if(!_wheel){
+        return;
+    }
+    const uint64_t elapsed = _wheel->now() - _wheel_synced;
+    _wheel_synced = _wheel->now();
+    if(elapsed > 0){
+        tick(elapsed);
+    }
+}
+
+void TCPSender::_arm_wheel() {
+    if(!_wheel){
+        return;
+    }
+    _wheel->cancel(_wheel_timer);
+    _wheel_timer = TimerWheel::NO_TIMER;
+    if(start){
+        _wheel_timer = _wheel->schedule_in(RTO, [this] { _sync_wheel(); });
+    }
+}
+
+uint64_t TCPSender::_window_end() const {
+    // 发送窗口 = min(拥塞窗口, 接收窗口)
+    return ack_s + (_cc ? min<uint64_t>(_window, _cc->cwnd()) : _window);
+}
+
+uint64_t TCPSender::bytes_in_flight() const { return {_next_seqno - _paced_bytes - ack_s}; }
 
 void TCPSender::fill_window() {     
+    _sync_wheel();
     // 已发送FIN
     if(fin_send){
         return;
     }
-    uint64_t end = ack_s + _window;
+    uint64_t end = _window_end();
     while(_next_seqno < end){
+        if(_next_seqno != 0 && _hold_small_segment()){
+            break;
+        }
         TCPSegment seg = TCPSegment(); 
         // SYN尚未发送
         if(_next_seqno == 0){
             seg.header().syn = true;
+            // SYN中携带SACK-permitted选项
+            if(_sack_enabled){
+                seg.header().options.sack_permitted = true;
+            }
+            // SYN中声明本端接收窗口的扩大因子
+            if(_wscale_enabled){
+                seg.header().options.window_scale = _rcv_wscale;
+            }
+            seg.header().fit_options();
         } 
         // 设置seqno序号   
         seg.header().seqno = wrap(_next_seqno , _isn);
         // 判断最大装载数据量并装载数据
         uint64_t w_size = end - _next_seqno;
-        uint64_t data_size = (TCPConfig::MAX_PAYLOAD_SIZE <= w_size) ? TCPConfig::MAX_PAYLOAD_SIZE : w_size;   
-        seg.payload() = string(stream_in().read(data_size));  
+        // TSO：SYN之后的段最多装载TSO_MAX_SEGMENTS个MSS，序列化时再切分
+        const uint64_t max_payload = (_tso && _next_seqno != 0)
+                                         ? TCPConfig::TSO_MAX_SEGMENTS * TCPConfig::MAX_PAYLOAD_SIZE
+                                         : TCPConfig::MAX_PAYLOAD_SIZE;
+        // 每个段只装载一段连续存储：chunk中的字节直接共享存储，环形区中的字节只拷贝一次
+        const uint64_t data_size = stream_in().run_size(min(max_payload, w_size));
+        seg.payload() = Buffer(stream_in().read_buffers(data_size));
+        if(seg.payload().size() > TCPConfig::MAX_PAYLOAD_SIZE){
+            seg.set_gso_size(TCPConfig::MAX_PAYLOAD_SIZE);
+        }
 
         if((!fin_send) && stream_in().eof() && ((_next_seqno + seg.length_in_sequence_space()) < end)){
             seg.header().fin = true;
@@ -51,69 +136,181 @@ void TCPSender::fill_window() {
         // 没数据没SYN没FIN就退出循环
         if(seg.length_in_sequence_space() > 0){
             _next_seqno += seg.length_in_sequence_space();
-            _segments_out.push(seg);
-            start = true;
-            _segments_noack.insert({_next_seqno, seg});
+            // 限速时段先在_paced中等待，放行时才算发出
+            if(_pacing){
+                _paced_bytes += seg.length_in_sequence_space();
+                _paced->push(move(seg));
+            }else{
+                _send(move(seg));
+            }
         }else{
             break;
         }       
     }
+    if(_pacing){
+        _release_paced();
+    }
+    _arm_wheel();
 }
 
 //! \param ackno The remote receiver's ackno (acknowledgment number)
 //! \param window_size The remote receiver's advertised window size
-void TCPSender::ack_received(const WrappingInt32 ackno, const uint16_t window_size) { 
+void TCPSender::ack_received(const WrappingInt32 ackno, const uint64_t window_size) { 
+    _sync_wheel();
     // ack无效判断
     uint64_t new_ack = unwrap(ackno,_isn,_next_seqno);
-    if(new_ack > _next_seqno){
+    // 不能确认还在_paced中等待的段
+    if(new_ack > _next_seqno - _paced_bytes){
         return ;
     }
+    // 重复确认：不推进ackno、窗口不变且仍有数据在途
+    if(_fast_retransmit && new_ack == ack_s && bytes_in_flight() > 0 && window_size == _window){
+        _dupacks ++;
+        if(_dupacks == TCPConfig::DUPACK_THRESHOLD && !_recovery_point.has_value()){
+            // 恢复点只包括已发出的段
+            _recovery_point = _next_seqno - _paced_bytes;
+            _high_rxt = ack_s;
+            if(_cc){
+                _cc->on_loss(_now, bytes_in_flight());
+            }
+            _retransmit_holes();
+        }
+    }
     // 超时重传操作
     if(new_ack > ack_s){
-        RTO = _initial_retransmission_timeout;
+        _dupacks = 0;
         retransnum = 0;
+        const uint64_t acked = new_ack - ack_s;
         ack_s = new_ack;  
-        //剔除已被确认的Segment
-        for(auto iter = _segments_noack.begin();iter != _segments_noack.end();){
-            if(iter->first <= ack_s ){
-                iter = _segments_noack.erase(iter);
+        //剔除已被确认的Segment，用最新被确认的段测量RTT
+        bool rtt_valid = false;
+        uint64_t rtt = 0;
+        while(!_segments_noack.empty() && _segments_noack.front().seqno_end <= ack_s){
+            const OutstandingSegment &front = _segments_noack.front();
+            if(front.sacked){
+                _bytes_sacked -= front.segment.length_in_sequence_space();
+            }
+            rtt_valid = !front.retransmitted;
+            rtt = _now - front.sent_at;
+            _segments_noack.pop_front();
+        }
+        if(_repacketize && !_segments_noack.empty()){
+            _trim_front();
+        }
+        if(rtt_valid){
+            _rtt_sample(rtt);
+        }
+        RTO = _rto_estimate;
+        // 部分确认说明还有丢失的段，立即重传；完全确认则退出恢复
+        if(_recovery_point.has_value()){
+            if(ack_s >= _recovery_point.value()){
+                _recovery_point.reset();
             }else{
-                iter ++;
+                _retransmit_holes();
             }
         }
+        if(_cc){
+            _cc->on_ack(_now, ack_s, acked, bytes_in_flight());
+        }
     }    
     // 修正_ack和窗口大小
     if(window_size != 0){
         _window = window_size;
+        window_zero = false;
     }else{
         window_zero = true;
         _window = 1;
     }
     
-    if(ack_s == _next_seqno){
+    if(_segments_noack.empty()){
         start = false;
     }
+    if(_pacing){
+        _update_pacing_rate();
+    }
+    _arm_wheel();
 
 }
 
+//! \param header the header of a segment received from the peer
+void TCPSender::ack_received(const TCPHeader &header) {
+    // SYN中的窗口字段不扩大
+    if(header.syn && _wscale_enabled && header.options.window_scale.has_value()){
+        _snd_wscale = header.options.window_scale;
+    }
+    const uint64_t window = header.syn ? header.win : uint64_t{header.win} << _snd_wscale.value_or(0);
+    // 先更新SACK记录，重复确认和部分确认时据此判断空洞
+    if(_sack_enabled){
+        _process_sack(header);
+    }
+    if(header.ack){
+        ack_received(header.ackno, window);
+    }
+}
+
+void TCPSender::_process_sack(const TCPHeader &header) {
+    for(const auto &block : header.options.sack){
+        uint64_t left = unwrap(block.left, _isn, ack_s);
+        const uint64_t right = unwrap(block.right, _isn, ack_s);
+        // 忽略无效、已被累计确认或超出已发送范围的块（_paced中的段尚未发出）
+        if(right <= left || right <= ack_s || right > _next_seqno - _paced_bytes){
+            continue;
+        }
+        // 块的左边可能低于累计确认号，截掉已确认的部分
+        left = max(left, ack_s);
+        // 标记完全落在块内的段：二分查找第一个结束序号大于left的段
+        auto iter = upper_bound(_segments_noack.begin(), _segments_noack.end(), left,
+                                [](const uint64_t seqno, const OutstandingSegment &s) { return seqno < s.seqno_end; });
+        for(; iter != _segments_noack.end() && iter->seqno_end <= right; iter++){
+            const size_t len = iter->segment.length_in_sequence_space();
+            if(iter->seqno_end - len >= left && !iter->sacked){
+                iter->sacked = true;
+                _bytes_sacked += len;
+            }
+        }
+    }
+}
+
 //! \param[in] ms_since_last_tick the number of milliseconds since the last call to this method
 void TCPSender::tick(const size_t ms_since_last_tick) { 
-    if(!start){
+    _now += ms_since_last_tick;
+    // 本次放行的段从现在开始计时
+    const bool timer_running = start;
+    if(_pacing){
+        _pacer.advance(ms_since_last_tick);
+        _release_paced();
+    }
+    if(!timer_running){
+        _arm_wheel();
         return;
     }
     if(RTO <= ms_since_last_tick){
         if(retransnum == 0){
-            _rto_base = _initial_retransmission_timeout*2;
+            _rto_base = _rto_estimate*2;
         }else{
             _rto_base = _rto_base*2;
         }
-        RTO = window_zero ? _initial_retransmission_timeout:_rto_base;
+        if(_adaptive_rto){
+            _rto_base = min(_rto_base, _rto_max);
+        }
+        RTO = window_zero ? _rto_estimate:_rto_base;
         retransnum ++;
+        _dupacks = 0;
+        _recovery_point.reset();
+        // 零窗口探测超时不代表拥塞
+        if(_cc && !window_zero){
+            _cc->on_rto(_now, bytes_in_flight());
+        }
+
+        // 接收端可能撤销SACK（RFC 2018第8节）：超时后丢弃SACK记录
+        for(OutstandingSegment &outstanding : _segments_noack){
+            outstanding.sacked = false;
+        }
+        _bytes_sacked = 0;
 
-        //重传数据
-        auto iter = _segments_noack.begin();
-        if(iter != _segments_noack.end()){
-            _segments_out.push(iter->second);
+        //重传最早的未确认段
+        if(!_segments_noack.empty()){
+            _retransmit_at(0);
             start = true;
         }else{
             printf("重传为空！！！\n");
@@ -121,6 +318,198 @@ void TCPSender::tick(const size_t ms_since_last_tick) {
     }else{
         RTO -= ms_since_last_tick;
     }
+    _arm_wheel();
+}
+
+void TCPSender::_rtt_sample(const uint64_t rtt) {
+    const uint64_t rtt8 = rtt * 8;
+    if(!_srtt8.has_value()){
+        _srtt8 = rtt8;
+        _rttvar8 = rtt8 / 2;
+    }else{
+        const uint64_t err = _srtt8.value() > rtt8 ? _srtt8.value() - rtt8 : rtt8 - _srtt8.value();
+        _rttvar8 = (3 * _rttvar8 + err) / 4;
+        _srtt8 = (7 * _srtt8.value() + rtt8) / 8;
+    }
+    if(!_adaptive_rto){
+        return;
+    }
+    // RTO = SRTT + max(G, 4*RTTVAR)，时钟粒度G为1ms，向上取整
+    const uint64_t rto = (_srtt8.value() + max<uint64_t>(8, 4 * _rttvar8) + 7) / 8;
+    _rto_estimate = static_cast<unsigned int>(min<uint64_t>(max<uint64_t>(rto, _rto_min), _rto_max));
+}
+
+optional<uint64_t> TCPSender::smoothed_rtt() const {
+    if(!_srtt8.has_value()){
+        return {};
+    }
+    return _srtt8.value() / 8;
+}
+
+void TCPSender::_retransmit_first() {
+    if(_segments_noack.empty()){
+        return;
+    }
+    _retransmit_at(0);
+    RTO = _rto_estimate;
+}
+
+void TCPSender::_retransmit_holes() {
+    // 没有SACK信息时按NewReno只重传第一个段
+    if(_bytes_sacked == 0){
+        _retransmit_first();
+        return;
+    }
+    uint64_t high = 0;
+    for(auto iter = _segments_noack.rbegin(); iter != _segments_noack.rend(); iter++){
+        if(iter->sacked){
+            high = iter->seqno_end;
+            break;
+        }
+    }
+    // 重传最高SACK段之下、本次恢复中尚未重传过的空洞
+    for(size_t i = 0; i < _segments_noack.size() && _segments_noack[i].seqno_end < high; i++){
+        const OutstandingSegment &outstanding = _segments_noack[i];
+        if(outstanding.sacked || outstanding.seqno_end - outstanding.segment.length_in_sequence_space() < _high_rxt){
+            continue;
+        }
+        _retransmit_at(i);
+        _high_rxt = _segments_noack[i].seqno_end;
+    }
+    RTO = _rto_estimate;
+}
+
+void TCPSender::_retransmit_at(const size_t index) {
+    if(_repacketize){
+        _coalesce(index);
+    }
+    _retransmit(_segments_noack[index]);
+}
+
+void TCPSender::_trim_front() {
+    OutstandingSegment &front = _segments_noack.front();
+    TCPSegment &seg = front.segment;
+    const uint64_t begin = front.seqno_end - seg.length_in_sequence_space();
+    if(begin >= ack_s){
+        return;
+    }
+    uint64_t acked = ack_s - begin;
+    // 被裁掉的部分不再算作已SACK的字节
+    if(front.sacked){
+        _bytes_sacked -= acked;
+    }
+    // SYN占第一个序号，去掉SYN时一并去掉只属于SYN的选项
+    if(seg.header().syn){
+        seg.header().syn = false;
+        seg.header().options = {};
+        seg.header().fit_options();
+        acked--;
+    }
+    seg.payload().remove_prefix(acked);
+    seg.header().seqno = wrap(ack_s, _isn);
+}
+
+void TCPSender::_coalesce(const size_t index) {
+    const OutstandingSegment &first = _segments_noack[index];
+    if(first.segment.header().syn || first.segment.header().fin){
+        return;
+    }
+    size_t payload = first.segment.payload().size();
+    size_t last = index + 1;
+    while(last < _segments_noack.size()){
+        const OutstandingSegment &next = _segments_noack[last];
+        if(next.sacked || payload + next.segment.payload().size() > TCPConfig::MAX_PAYLOAD_SIZE){
+            break;
+        }
+        payload += next.segment.payload().size();
+        last++;
+        if(next.segment.header().fin){
+            break;
+        }
+    }
+    if(last == index + 1){
+        return;
+    }
+
+    string data;
+    data.reserve(payload);
+    for(size_t i = index; i < last; i++){
+        data.append(_segments_noack[i].segment.payload().str());
+    }
+    OutstandingSegment &merged = _segments_noack[index];
+    merged.segment.payload() = Buffer(move(data));
+    merged.segment.header().fin = _segments_noack[last - 1].segment.header().fin;
+    merged.seqno_end = _segments_noack[last - 1].seqno_end;
+    // 合并后的段是一次重传，从本次发送开始计时，且不能用于测量RTT
+    merged.sent_at = _now;
+    merged.retransmitted = true;
+    _segments_noack.erase(_segments_noack.begin() + index + 1, _segments_noack.begin() + last);
+}
+
+bool TCPSender::_hold_small_segment() const {
+    if(stream_in().input_ended() || stream_in().buffer_size() >= TCPConfig::MAX_PAYLOAD_SIZE){
+        return false;
+    }
+    // Nagle：有未确认的数据时小段等待确认
+    return _corked || (_nagle && bytes_in_flight() > 0);
+}
+
+void TCPSender::uncork() {
+    _corked = false;
+    fill_window();
+}
+
+void TCPSender::_retransmit(OutstandingSegment &outstanding) {
+    _segments_out.push(outstanding.segment);
+    outstanding.retransmitted = true;
+    if(_pacing){
+        _pacer.consume(outstanding.segment.length_in_sequence_space());
+    }
+}
+
+void TCPSender::_update_pacing_rate() {
+    if(_pacing_rate > 0){
+        _pacer.set_rate(static_cast<double>(_pacing_rate) / 1000);
+        return;
+    }
+    // 没有RTT样本时不限速
+    if(!_srtt8.has_value() || _srtt8.value() == 0){
+        _pacer.set_rate(0);
+        return;
+    }
+    // 慢启动阶段速率为窗口/RTT的2倍，之后为1.2倍
+    const uint64_t window = _cc ? min<uint64_t>(_window, _cc->cwnd()) : _window;
+    const double gain = (_cc && _cc->cwnd() < _cc->ssthresh()) ? 2.0 : 1.2;
+    _pacer.set_rate(gain * static_cast<double>(window) * 8 / static_cast<double>(_srtt8.value()));
+}
+
+void TCPSender::_release_paced() {
+    while(!_paced->empty() && _pacer.ready()){
+        const size_t len = _paced->front().length_in_sequence_space();
+        _pacer.consume(len);
+        _paced_bytes -= len;
+        _send(move(_paced->front()));
+        _paced->pop();
+    }
+}
+
+void TCPSender::_send(TCPSegment &&seg) {
+    // 放行的段总在已发送部分的末尾
+    const uint64_t seqno_end = _next_seqno - _paced_bytes;
+    // 两份拷贝共享同一个payload Buffer
+    _segments_out.push(seg);
+    _segments_noack.push_back({move(seg), seqno_end, _now, false, false});
+    start = true;
+    if(_cc){
+        _cc->on_send(_now, seqno_end, bytes_in_flight());
+    }
+}
+
+optional<uint64_t> TCPSender::next_release() const {
+    if(!_paced || _paced->empty()){
+        return {};
+    }
+    return _pacer.time_until_ready();
 }
 
 unsigned int TCPSender::consecutive_retransmissions() const { return {retransnum}; }
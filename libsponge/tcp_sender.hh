@@ -2,13 +2,17 @@
 #define SPONGE_LIBSPONGE_TCP_SENDER_HH
 
 #include "byte_stream.hh"
+#include "pacer.hh"
+#include "segment_ring.hh"
 #include "tcp_config.hh"
 #include "tcp_segment.hh"
+#include "timer_wheel.hh"
 #include "wrapping_integers.hh"
 
+#include <deque>
 #include <functional>
-#include <queue>
-#include <map>
+#include <memory>
+#include <optional>
 //! \brief The "sender" part of a TCP implementation.
 
 //! Accepts a ByteStream, divides it up into segments and sends the
@@ -25,13 +29,116 @@ class TCPSender {
 
     //! outbound queue of segments that the TCPSender wants sent
     // TCPsender要发送的Segment队列
-    std::queue<TCPSegment> _segments_out{};
-    std::map<uint64_t,TCPSegment> _segments_noack{};
+    SegmentRing _segments_out{};
+
+    //! a segment that has been sent but not yet acknowledged
+    struct OutstandingSegment {
+        TCPSegment segment;  //!< shares its payload Buffer with the copy handed to `_segments_out`
+        uint64_t seqno_end;  //!< absolute seqno just past the segment
+        uint64_t sent_at;    //!< `_now` when the segment was first sent, or resent after coalescing
+        bool retransmitted;  //!< Karn's algorithm: a retransmitted segment gives no RTT sample
+        bool sacked;         //!< the receiver has SACKed the whole segment
+    };
+    //! outstanding segments in sequence order; cumulative ACKs pop from the front
+    // 按序号排列，确认时从队头移除
+    std::deque<OutstandingSegment> _segments_noack{};
+
+    //! SACK scoreboard: the SACKed byte count; discarded on RTO, since the receiver may renege
+    // 已被SACK确认的字节数，超时后清空
+    size_t _bytes_sacked = 0;
+    bool _sack_enabled = false;
+
+    //! Mark outstanding segments covered by the SACK blocks in `header`
+    void _process_sack(const TCPHeader &header);
 
     //! retransmission timer for the connection
     // 重传计时器RTO的初始值 1000
     unsigned int _initial_retransmission_timeout;
     unsigned int _rto_base;
+
+    //! RTT estimation ([RFC 6298](\ref rfc::rfc6298)); SRTT and RTTVAR are kept in 1/8 ms
+    // SRTT总是测量；未启用自适应时RTO始终为初始值
+    bool _adaptive_rto = false;
+    unsigned int _rto_min = TCPConfig::RTO_MIN_DFLT;
+    unsigned int _rto_max = TCPConfig::RTO_MAX_DFLT;
+    std::optional<uint64_t> _srtt8{};
+    uint64_t _rttvar8 = 0;
+    //! the retransmission timeout before any backoff
+    unsigned int _rto_estimate;
+
+    //! Fold a new RTT measurement (in ms) into SRTT, RTTVAR and, with adaptive_rto, the RTO
+    void _rtt_sample(const uint64_t rtt);
+
+    //! fast retransmit and NewReno fast recovery ([RFC 6582](\ref rfc::rfc6582))
+    // 恢复期间记录进入时的最高序号，部分确认时重传下一个空洞
+    bool _fast_retransmit = false;
+    unsigned int _dupacks = 0;
+    std::optional<uint64_t> _recovery_point{};
+    //! with SACK, the end of the last hole resent in this recovery (HighRxt in [RFC 6675](\ref rfc::rfc6675))
+    uint64_t _high_rxt = 0;
+
+    //! Resend the oldest outstanding segment and restart the retransmission timer
+    void _retransmit_first();
+
+    //! Loss recovery step: resend the holes below the highest SACKed segment that were not yet resent in
+    //! this recovery, or without SACK information only the oldest outstanding segment
+    void _retransmit_holes();
+
+    //! Resend an outstanding segment (retransmissions are not held back by the pacer)
+    void _retransmit(OutstandingSegment &outstanding);
+
+    //! repacketization: retransmit only unacknowledged bytes, in as few segments as possible
+    // 合并后的段需要复制payload，只在重传时进行
+    bool _repacketize = false;
+
+    //! Drop the acknowledged prefix of the oldest outstanding segment
+    void _trim_front();
+
+    //! Merge the outstanding segment at `index` with the un-SACKed segments after it, up to MAX_PAYLOAD_SIZE
+    void _coalesce(const size_t index);
+
+    //! Coalesce (if enabled) and resend the outstanding segment at `index`
+    void _retransmit_at(const size_t index);
+
+    //! segmentation offload: one super segment of up to TSO_MAX_SEGMENTS wire segments per fill_window step
+    bool _tso = false;
+
+    //! pacing: new segments wait in `_paced` until the pacer lets them into `_segments_out`; they take
+    //! up sequence space but are not in flight (nor timed) until released
+    bool _pacing = false;
+    size_t _pacing_rate = 0;
+    Pacer _pacer{TCPConfig::PACING_BURST};
+    std::unique_ptr<SegmentRing> _paced{};  //!< only allocated when pacing is enabled
+    size_t _paced_bytes = 0;  //!< sequence space held in `_paced`
+
+    //! Recompute the pacing rate from the window and SRTT (unless a fixed rate is configured)
+    void _update_pacing_rate();
+
+    //! Move as many held segments to `_segments_out` as the pacer allows
+    void _release_paced();
+
+    //! Hand a new segment to `_segments_out`, track it as outstanding and start the timer
+    void _send(TCPSegment &&seg);
+
+    //! Nagle's algorithm and cork: hold back data that would make a segment smaller than MAX_PAYLOAD_SIZE
+    // 输入结束时不再等待
+    bool _nagle = false;
+    bool _corked = false;
+
+    //! Should fill_window wait for more data before sending a small segment?
+    bool _hold_small_segment() const;
+
+    //! a TimerWheel that runs the retransmission timer instead of tick(), if attached
+    // 只在计时器到期时回调，空闲连接不需要tick
+    TimerWheel *_wheel = nullptr;
+    TimerWheel::TimerId _wheel_timer = TimerWheel::NO_TIMER;
+    uint64_t _wheel_synced = 0;  //!< wheel time already passed to tick()
+
+    //! Pass the wheel time elapsed since the last sync to tick()
+    void _sync_wheel();
+
+    //! Schedule a wheel timer for the retransmission timer's expiry, or cancel it if the timer is stopped
+    void _arm_wheel();
     //! outgoing stream of bytes that have not yet been sent
     // 尚未发送的字节流 capacity = 64000
     ByteStream _stream;
@@ -40,7 +147,22 @@ class TCPSender {
     // 下一个要发送的字节的绝对序列号
     uint64_t _next_seqno{0};
 
-    uint16_t _window = 1;
+    //! the peer's receive window, already scaled
+    uint64_t _window = 1;
+
+    //! window scaling ([RFC 7323](\ref rfc::rfc7323)): our announced shift, and the peer's once both sides agreed
+    // 双方SYN都带有窗口扩大选项后才生效
+    bool _wscale_enabled = false;
+    uint8_t _rcv_wscale = 0;
+    std::optional<uint8_t> _snd_wscale{};
+
+    //! congestion control, or nullptr to be limited by the receiver's window only
+    std::unique_ptr<CongestionController> _cc{};
+    //! milliseconds since construction, as told by tick()
+    uint64_t _now = 0;
+
+    //! The highest sequence number the window allows: ackno + min(cwnd, rwnd)
+    uint64_t _window_end() const;
     bool window_zero = false;  
     bool fin_send = false;
 
@@ -56,6 +178,28 @@ class TCPSender {
               const uint16_t retx_timeout = TCPConfig::TIMEOUT_DFLT,
               const std::optional<WrappingInt32> fixed_isn = {});
 
+    //! Initialize a TCPSender from the sender fields of a TCPConfig
+    //! (send_capacity, rt_timeout, fixed_isn, sack, window_scaling, congestion_control,
+    //! adaptive_rto, rto_min, rto_max, fast_retransmit, pacing, pacing_rate, nagle, repacketize, tso)
+    explicit TCPSender(const TCPConfig &config);
+
+    //! Cancels the TimerWheel timer, if any
+    ~TCPSender();
+
+    //! \note A TCPSender is neither copyable nor movable: the TimerWheel timer calls back into it by address.
+    //! Construct it in place (or hold it through a pointer) where it will live.
+    TCPSender(const TCPSender &) = delete;
+    TCPSender &operator=(const TCPSender &) = delete;
+    TCPSender(TCPSender &&) = delete;
+    TCPSender &operator=(TCPSender &&) = delete;
+
+    //! \brief Run the retransmission timer on `wheel` instead of calling tick()
+    //! \details The sender schedules a wheel timer whenever its retransmission timer is running and is
+    //! called back only on expiry, so an idle sender costs nothing per millisecond. Elapsed wheel time is
+    //! passed to tick() on expiry and before each ack_received() and fill_window(), so the pacer and
+    //! delayed work still see it then. The wheel must outlive the sender.
+    void attach_timer_wheel(TimerWheel &wheel);
+
     //! \name "Input" interface for the writer
     //!@{
     ByteStream &stream_in() { return _stream; }
@@ -69,7 +213,12 @@ class TCPSender {
     // 从接收方收到一个确认信息，
     // 包括窗口的左边缘（= ackno）和右边缘（= ackno + window size）
     // 查看其未完成的段的集合，并删除任何现在已被完全确认的段
-    void ack_received(const WrappingInt32 ackno, const uint16_t window_size);
+    void ack_received(const WrappingInt32 ackno, const uint64_t window_size);
+
+    //! \brief A segment carrying an acknowledgment was received
+    //! \details Uses the ackno and window, plus any SACK blocks when SACK is enabled. When window scaling is
+    //! enabled, a SYN carrying the window scale option turns on scaling of the `win` field of later segments.
+    void ack_received(const TCPHeader &header);
 
     //! \brief Generate an empty-payload segment (useful for creating empty ACK segments)
     // 应该生成并发送一个在序列空间中长度为零的TCPSegment
@@ -79,6 +228,12 @@ class TCPSender {
     // 从ByteStream读取并TCPSegments的形式发送尽可能多的字节
     void fill_window();
 
+    //! \brief Stop sending segments smaller than MAX_PAYLOAD_SIZE until uncork() (like TCP_CORK)
+    void cork() { _corked = true; }
+
+    //! \brief Send any data held back by cork(), then resume normal sending
+    void uncork();
+
     //! \brief Notifies the TCPSender of the passage of time
     // 将检查重传计时器是否已过期，如果是，则以最低的序列号重传未发送的段
     void tick(const size_t ms_since_last_tick);
@@ -93,6 +248,34 @@ class TCPSender {
     // 有多少个字节已发送但尚未确认
     size_t bytes_in_flight() const;
 
+    //! \brief How many of the bytes in flight has the receiver selectively acknowledged?
+    size_t bytes_sacked() const { return _bytes_sacked; }
+
+    //! \brief The congestion controller, or nullptr if none is configured
+    const CongestionController *congestion_controller() const { return _cc.get(); }
+
+    //! \brief The smoothed round-trip time in milliseconds, once a sample has been taken
+    std::optional<uint64_t> smoothed_rtt() const;
+
+    //! \brief The round-trip time variation in milliseconds
+    uint64_t rtt_variation() const { return _rttvar8 / 8; }
+
+    //! \brief The retransmission timeout in milliseconds, not counting exponential backoff
+    unsigned int retransmission_timeout() const { return _rto_estimate; }
+
+    //! \brief Milliseconds until the pacer releases the next held segment
+    //! \returns nothing if no segments are held, so an event loop can sleep until the next ACK
+    std::optional<uint64_t> next_release() const;
+
+    //! \brief The pacing rate in bytes per second (0 when unpaced)
+    uint64_t pacing_rate() const { return static_cast<uint64_t>(_pacer.rate() * 1000); }
+
+    //! \brief Is the sender corked?
+    bool corked() const { return _corked; }
+
+    //! \brief Is the sender recovering from a loss found by duplicate ACKs?
+    bool in_fast_recovery() const { return _recovery_point.has_value(); }
+
     //! \brief Number of consecutive retransmissions that have occurred in a row
     // 返回连续重传的次数
     unsigned int consecutive_retransmissions() const;
@@ -103,7 +286,13 @@ class TCPSender {
     //! (ackno and window size) before sending.
     // TCPSender中排队等待传输的TCPSegments
     // 需要匹配TCPReceiver的ack和窗口大小
-    std::queue<TCPSegment> &segments_out() { return _segments_out; }
+    //! With TSO these may be super segments: use TCPSegment::split() or serialize_split() to put them on the wire.
+    SegmentRing &segments_out() { return _segments_out; }
+
+    //! \brief Move up to `max` queued segments, oldest first, into `out`
+    //! \returns the number of segments moved
+    // 批量取出待发送的段，避免逐个pop
+    size_t drain_segments(TCPSegment *out, const size_t max) { return _segments_out.drain(out, max); }
     //!@}
 
     //! \name What is the next sequence number? (used for testing)
@@ -7,7 +7,17 @@ void Buffer::remove_prefix(const size_t n) {
         throw out_of_range("Buffer::remove_prefix");
     }
     _starting_offset += n;
-    if (_storage and _starting_offset == _storage->size()) {
+    if (_storage and _starting_offset + _ending_offset == _storage->size()) {
+        _storage.reset();
+    }
+}
+
+void Buffer::remove_suffix(const size_t n) {
+    if (n > str().size()) {
+        throw out_of_range("Buffer::remove_suffix");
+    }
+    _ending_offset += n;
+    if (_storage and _starting_offset + _ending_offset == _storage->size()) {
         _storage.reset();
     }
 }
@@ -70,6 +80,12 @@ BufferViewList::BufferViewList(const BufferList &buffers) {
     }
 }
 
+void BufferViewList::append(std::string_view str) {
+    if (not str.empty()) {
+        _views.push_back(str);
+    }
+}
+
 void BufferViewList::remove_prefix(size_t n) {
     while (n > 0) {
         if (_views.empty()) {
@@ -94,6 +110,15 @@ size_t BufferViewList::size() const {
     return ret;
 }
 
+string BufferViewList::concatenate() const {
+    std::string ret;
+    ret.reserve(size());
+    for (const auto &view : _views) {
+        ret.append(view);
+    }
+    return ret;
+}
+
 vector<iovec> BufferViewList::as_iovecs() const {
     vector<iovec> ret;
     ret.reserve(_views.size());
@@ -81,6 +81,44 @@ string FileDescriptor::read(const size_t limit) {
     return ret;
 }
 
+//! \param[in] buffers are the regions to fill, in order; fewer bytes than their total size may be read
+size_t FileDescriptor::read(const vector<iovec> &buffers) {
+    size_t size_to_read = 0;
+    for (const auto &x : buffers) {
+        size_to_read += x.iov_len;
+    }
+
+    const ssize_t bytes_read = SystemCall("readv", ::readv(fd_num(), buffers.data(), buffers.size()));
+    if (size_to_read > 0 && bytes_read == 0) {
+        _internal_fd->_eof = true;
+    }
+    if (bytes_read > static_cast<ssize_t>(size_to_read)) {
+        throw runtime_error("readv() read more than requested");
+    }
+
+    register_read();
+
+    return bytes_read;
+}
+
+//! \param[in] out is the descriptor the bytes are moved to
+//! \param[in] limit is the maximum number of bytes to move; fewer bytes may be moved
+size_t FileDescriptor::splice_into(FileDescriptor &out, const size_t limit) {
+    const ssize_t bytes_moved =
+        SystemCall("splice", ::splice(fd_num(), nullptr, out.fd_num(), nullptr, limit, SPLICE_F_MOVE), EAGAIN);
+    if (bytes_moved < 0) {
+        return 0;  // EAGAIN: nothing to read, or no room to write
+    }
+    if (limit > 0 && bytes_moved == 0) {
+        _internal_fd->_eof = true;
+    }
+
+    register_read();
+    out.register_write();
+
+    return bytes_moved;
+}
+
 // 将buffer中的内容写入fd中
 size_t FileDescriptor::write(BufferViewList buffer, const bool write_all) {
     size_t total_bytes_written = 0;
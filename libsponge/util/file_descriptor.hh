@@ -63,6 +63,15 @@ class FileDescriptor {
     // 向str中读取最多limit字节的数据
     void read(std::string &str, const size_t limit = std::numeric_limits<size_t>::max());
 
+    //! Read into discontiguous buffers with a single [readv(2)](\ref man2::readv)
+    //! \returns the number of bytes read
+    size_t read(const std::vector<iovec> &buffers);
+
+    //! Move up to `limit` bytes to `out` inside the kernel with [splice(2)](\ref man2::splice)
+    //! \note One of the two descriptors must be a pipe.
+    //! \returns the number of bytes moved (0 if a non-blocking side would have blocked)
+    size_t splice_into(FileDescriptor &out, const size_t limit);
+
     //! Write a string, possibly blocking until all is written
     size_t write(const char *str, const bool write_all = true) { return write(BufferViewList(str), write_all); }
 
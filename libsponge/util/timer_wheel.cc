@@ -0,0 +1,139 @@
+#include "timer_wheel.hh"
+
+#include <algorithm>
+
+using namespace std;
+
+TimerWheel::TimerWheel(const uint64_t now) : _now(now) { _slots.fill(NIL); }
+
+void TimerWheel::_insert(const uint32_t index) {
+    Node &node = _nodes[index];
+    // the lowest level whose current revolution (or the next) reaches the deadline
+    unsigned level = 0;
+    while (level < LEVELS - 1 and (node.deadline >> (SLOT_BITS * level)) - (_now >> (SLOT_BITS * level)) >= SLOTS) {
+        level++;
+    }
+    uint64_t tick = node.deadline >> (SLOT_BITS * level);
+    const uint64_t current = _now >> (SLOT_BITS * level);
+    if (tick - current >= SLOTS) {
+        // beyond the top level: park in its last slot and re-file when it cascades
+        tick = current + SLOTS - 1;
+    }
+    node.slot = static_cast<uint32_t>(level * SLOTS + tick % SLOTS);
+    _level_size[level]++;
+    node.prev = NIL;
+    node.next = _slots[node.slot];
+    if (node.next != NIL) {
+        _nodes[node.next].prev = index;
+    }
+    _slots[node.slot] = index;
+}
+
+void TimerWheel::_unlink(const uint32_t index) {
+    Node &node = _nodes[index];
+    _level_size[node.slot / SLOTS]--;
+    if (node.prev != NIL) {
+        _nodes[node.prev].next = node.next;
+    } else {
+        _slots[node.slot] = node.next;
+    }
+    if (node.next != NIL) {
+        _nodes[node.next].prev = node.prev;
+    }
+    node.prev = node.next = NIL;
+}
+
+void TimerWheel::_release(const uint32_t index) {
+    Node &node = _nodes[index];
+    node.slot = NIL;
+    node.callback = nullptr;
+    node.generation++;
+    _free.push_back(index);
+    _size--;
+}
+
+TimerWheel::TimerId TimerWheel::schedule_at(const uint64_t deadline, Callback callback) {
+    uint32_t index;
+    if (_free.empty()) {
+        index = static_cast<uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+    } else {
+        index = _free.back();
+        _free.pop_back();
+    }
+    Node &node = _nodes[index];
+    node.deadline = deadline > _now ? deadline : _now + 1;
+    node.callback = move(callback);
+    _insert(index);
+    _size++;
+    return (uint64_t{node.generation} << 32) | index;
+}
+
+bool TimerWheel::cancel(const TimerId id) {
+    const uint32_t index = static_cast<uint32_t>(id);
+    if (index >= _nodes.size()) {
+        return false;
+    }
+    Node &node = _nodes[index];
+    if (node.slot == NIL or node.generation != static_cast<uint32_t>(id >> 32)) {
+        return false;
+    }
+    _unlink(index);
+    _release(index);
+    return true;
+}
+
+void TimerWheel::_cascade(const unsigned level) {
+    const uint32_t slot = level * SLOTS + static_cast<uint32_t>((_now >> (SLOT_BITS * level)) % SLOTS);
+    uint32_t index = _slots[slot];
+    _slots[slot] = NIL;
+    while (index != NIL) {
+        const uint32_t next = _nodes[index].next;
+        _level_size[level]--;
+        _insert(index);
+        index = next;
+    }
+}
+
+void TimerWheel::_step() {
+    _now++;
+    // higher levels first, so timers they re-file into the current slot of a lower level cascade too
+    for (unsigned level = LEVELS - 1; level > 0; level--) {
+        if ((_now & ((uint64_t{1} << (SLOT_BITS * level)) - 1)) == 0) {
+            _cascade(level);
+        }
+    }
+    const uint32_t slot = static_cast<uint32_t>(_now % SLOTS);
+    // take one timer at a time: a callback may cancel others in the same slot
+    while (_slots[slot] != NIL) {
+        const uint32_t index = _slots[slot];
+        _unlink(index);
+        Callback callback = move(_nodes[index].callback);
+        _release(index);
+        callback();
+    }
+}
+
+void TimerWheel::advance(const uint64_t ms) {
+    const uint64_t end = _now + ms;
+    while (_now < end) {
+        // nothing can fire before the next cascade of the lowest non-empty level: skip to just before it
+        unsigned level = 0;
+        while (level < LEVELS and _level_size[level] == 0) {
+            level++;
+        }
+        if (level == LEVELS) {
+            _now = end;
+            return;
+        }
+        if (level > 0) {
+            const uint64_t span = uint64_t{1} << (SLOT_BITS * level);
+            const uint64_t next_cascade = (_now / span + 1) * span;
+            _now = min(end, next_cascade - 1);
+            if (_now == end) {
+                return;
+            }
+        }
+        _step();
+    }
+}
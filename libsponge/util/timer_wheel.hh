@@ -0,0 +1,79 @@
+#ifndef SPONGE_LIBSPONGE_TIMER_WHEEL_HH
+#define SPONGE_LIBSPONGE_TIMER_WHEEL_HH
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+//! \brief A hierarchical timing wheel: many one-shot timers on a millisecond clock
+//! \details Four levels of 256 slots each. Level 0 holds timers due within the next 256 ms, one slot
+//! per millisecond; each higher level covers 256 times the span of the one below, and its slots are
+//! cascaded into lower levels as the clock reaches them. Scheduling and cancelling are O(1), and
+//! advancing the clock costs O(1) per millisecond plus O(1) per timer fired or cascaded, no matter
+//! how many timers are pending. Stretches with nothing filed at the lower levels are skipped, so
+//! advancing past idle time is cheap too.
+class TimerWheel {
+  public:
+    using TimerId = uint64_t;                //!< Identifies a scheduled timer; never reused
+    using Callback = std::function<void()>;  //!< Called when a timer expires
+
+    static constexpr TimerId NO_TIMER = 0;  //!< A TimerId that never refers to a timer
+
+  private:
+    static constexpr unsigned LEVELS = 4;
+    static constexpr unsigned SLOT_BITS = 8;
+    static constexpr uint32_t SLOTS = 1 << SLOT_BITS;
+    static constexpr uint32_t NIL = UINT32_MAX;
+
+    struct Node {
+        uint64_t deadline = 0;
+        Callback callback{};
+        uint32_t prev = NIL;
+        uint32_t next = NIL;
+        uint32_t slot = NIL;      //!< index into `_slots`, or NIL if the node is free
+        uint32_t generation = 1;  //!< bumped on release so stale TimerIds are rejected
+    };
+
+    std::vector<Node> _nodes{};
+    std::vector<uint32_t> _free{};
+    std::array<uint32_t, LEVELS * SLOTS> _slots{};  //!< head node of each slot's list
+    std::array<size_t, LEVELS> _level_size{};       //!< timers filed at each level
+    uint64_t _now;
+    size_t _size = 0;
+
+    void _insert(const uint32_t index);
+    void _unlink(const uint32_t index);
+    void _release(const uint32_t index);
+    void _cascade(const unsigned level);
+    void _step();
+
+  public:
+    //! \param[in] now the starting time, in milliseconds
+    explicit TimerWheel(const uint64_t now = 0);
+
+    //! \brief Call `callback` once the clock reaches `deadline` (or on the next millisecond, if it already has)
+    TimerId schedule_at(const uint64_t deadline, Callback callback);
+
+    //! \brief Call `callback` `delay` milliseconds from now (at least one)
+    TimerId schedule_in(const uint64_t delay, Callback callback) {
+        return schedule_at(_now + delay, std::move(callback));
+    }
+
+    //! \brief Cancel a pending timer
+    //! \returns `false` if the timer already fired or was cancelled
+    bool cancel(const TimerId id);
+
+    //! \brief Advance the clock by `ms` milliseconds, running the callbacks of timers that expire, in order
+    //! \details Callbacks may schedule and cancel timers, including on this wheel.
+    void advance(const uint64_t ms);
+
+    //! \brief The current time, in milliseconds
+    uint64_t now() const { return _now; }
+
+    //! \brief Number of pending timers
+    size_t size() const { return _size; }
+};
+
+#endif  // SPONGE_LIBSPONGE_TIMER_WHEEL_HH
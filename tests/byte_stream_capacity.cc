@@ -66,6 +66,7 @@ int main() {
             test.execute(RemainingCapacity{0});
             test.execute(BufferSize{2});
             test.execute(Peek{"at"});
+            test.execute(PeekViews{"at", 2});
         }
 
         {
@@ -0,0 +1,65 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main() {
+    try {
+        const string big_a(ByteStream::MIN_CHUNK_SIZE, 'a');
+        const string big_b(2 * ByteStream::MIN_CHUNK_SIZE, 'b');
+
+        {
+            ByteStreamTestHarness test{"small-rvalue-is-copied", 15};
+
+            test.execute(Write{"cat"}.by_rvalue().with_bytes_written(3));
+            test.execute(BufferSize{3});
+            test.execute(PeekViews{"cat", 1});
+        }
+
+        {
+            ByteStreamTestHarness test{"chunk-between-copies", 8192};
+
+            test.execute(Write{"xy"});
+            test.execute(Write{big_a}.by_rvalue().with_bytes_written(big_a.size()));
+            test.execute(Write{"z"});
+
+            test.execute(BytesWritten{big_a.size() + 3});
+            test.execute(RemainingCapacity{8192 - big_a.size() - 3});
+            test.execute(PeekViews{"xy" + big_a + "z", 3});
+
+            test.execute(Pop{1});
+            test.execute(PeekViews{"y" + big_a + "z", 3});
+            test.execute(Pop{2});
+            test.execute(PeekViews{big_a.substr(1) + "z", 2});
+            test.execute(Pop{big_a.size() - 1});
+            test.execute(PeekViews{"z", 1});
+            test.execute(Pop{1});
+            test.execute(BufferEmpty{true});
+            test.execute(BytesRead{big_a.size() + 3});
+        }
+
+        {
+            ByteStreamTestHarness test{"chunk-truncated-to-capacity", 3000};
+
+            test.execute(Write{big_a}.by_rvalue().with_bytes_written(big_a.size()));
+            test.execute(Write{big_b}.by_rvalue().with_bytes_written(3000 - big_a.size()));
+            test.execute(RemainingCapacity{0});
+            test.execute(PeekViews{big_a + big_b.substr(0, 3000 - big_a.size()), 2});
+
+            test.execute(Pop{big_a.size() + 10});
+            test.execute(Write{big_b}.by_rvalue().with_bytes_written(big_a.size() + 10));
+            test.execute(PeekViews{big_b.substr(0, 3000 - big_a.size() - 10) + big_b.substr(0, big_a.size() + 10), 2});
+            test.execute(EndInput{});
+            test.execute(Pop{3000});
+            test.execute(Eof{true});
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include "concurrent_byte_stream.hh"
+#include "eventloop.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace std;
+
+static string random_bytes(const size_t len) {
+    auto rd = get_random_generator();
+    string ret(len, 0);
+    generate(ret.begin(), ret.end(), [&] { return static_cast<char>(rd()); });
+    return ret;
+}
+
+//! The writer thread pushes `data` in random-sized pieces, then ends the input
+static thread start_writer(ConcurrentByteStream &stream, const string &data) {
+    return thread([&stream, &data] {
+        auto rd = get_random_generator();
+        size_t written = 0;
+        while (written < data.size()) {
+            stream.wait_writable();
+            const size_t len = uniform_int_distribution<size_t>{1, 5000}(rd);
+            written += stream.write(data.substr(written, len));
+        }
+        stream.end_input();
+    });
+}
+
+//! Read an eventfd's counter (which must be nonzero), resetting it
+static uint64_t event_count(FileDescriptor &event) {
+    const string raw = event.read(sizeof(uint64_t));
+    uint64_t count = 0;
+    memcpy(&count, raw.data(), sizeof(count));
+    return count;
+}
+
+int main() {
+    try {
+        // 只在空->非空、满->不满时发信号
+        {
+            ConcurrentByteStream stream{4};
+            stream.write("a");
+            stream.write("b");
+            stream.write("c");
+            if (event_count(stream.readable_event()) != 1) {
+                throw runtime_error("writes to a non-empty stream should not signal the reader");
+            }
+            stream.write("d");
+            stream.pop_output(1);
+            stream.pop_output(1);
+            if (event_count(stream.writable_event()) != 1) {
+                throw runtime_error("only the pop from a full stream should signal the writer");
+            }
+            stream.pop_output(2);
+            stream.write("e");
+            if (event_count(stream.readable_event()) != 1) {
+                throw runtime_error("a write to an empty stream should signal the reader");
+            }
+        }
+
+        const string data = random_bytes(4 * 1024 * 1024);
+
+        {
+            ConcurrentByteStream stream{3001};
+            thread writer = start_writer(stream, data);
+
+            auto rd = get_random_generator();
+            string received;
+            while (not stream.eof()) {
+                stream.wait_readable();
+                received += stream.read(uniform_int_distribution<size_t>{1, 5000}(rd));
+            }
+            writer.join();
+
+            if (received != data or stream.bytes_read() != data.size()) {
+                throw runtime_error("blocking reader saw different bytes than were written");
+            }
+        }
+
+        {
+            ConcurrentByteStream stream{65536};
+            thread writer = start_writer(stream, data);
+
+            string received;
+            EventLoop loop;
+            loop.add_rule(
+                stream.readable_event(),
+                Direction::In,
+                [&] {
+                    stream.readable_event().read(8);
+                    received += stream.read(stream.buffer_size());
+                },
+                [&] { return not stream.eof(); });
+            while (loop.wait_next_event(-1) != EventLoop::Result::Exit) {
+            }
+            writer.join();
+
+            if (received != data) {
+                throw runtime_error("EventLoop reader saw different bytes than were written");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+#include "byte_stream.hh"
+#include "pipe_byte_stream.hh"
+#include "socket.hh"
+#include "util.hh"
+
+#include <array>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+
+using namespace std;
+
+static pair<LocalStreamSocket, LocalStreamSocket> socket_pair() {
+    array<int, 2> fds{};
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()));
+    return {LocalStreamSocket{FileDescriptor(fds[0])}, LocalStreamSocket{FileDescriptor(fds[1])}};
+}
+
+//! data -> [in_w, in_r] -> stream -> [out_w, out_r] -> received
+template <typename StreamT>
+static void pipe_through(StreamT &stream, const size_t capacity, const string &data) {
+    auto rd = get_random_generator();
+    auto [in_w, in_r] = socket_pair();
+    auto [out_w, out_r] = socket_pair();
+
+    size_t sent = 0;
+    string received;
+    while (received.size() < data.size()) {
+        if (sent < data.size() and sent - stream.bytes_written() < 65536) {
+            const size_t len = uniform_int_distribution<size_t>{1, 4096}(rd);
+            sent += in_w.write(data.substr(sent, len));
+        }
+        if (sent > stream.bytes_written()) {
+            stream.write_from(in_r, uniform_int_distribution<size_t>{1, 4096}(rd));
+        }
+        const string peeked = stream.peek_output(16);
+        if (peeked != data.substr(stream.bytes_read(), peeked.size())) {
+            throw runtime_error("peek_output returned the wrong bytes");
+        }
+        const size_t n = stream.read_into(out_w, uniform_int_distribution<size_t>{1, 4096}(rd));
+        const size_t expected = received.size() + n;
+        while (received.size() < expected) {
+            received += out_r.read(expected - received.size());
+        }
+        if (stream.buffer_size() > capacity) {
+            throw runtime_error("stream exceeded its capacity");
+        }
+    }
+
+    if (received != data) {
+        throw runtime_error("bytes piped through write_from/read_into were corrupted");
+    }
+
+    in_w.shutdown(SHUT_WR);
+    if (stream.write_from(in_r, 100) != 0 or not in_r.eof()) {
+        throw runtime_error("write_from did not report EOF on the input");
+    }
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        string data(1024 * 1024, 0);
+        generate(data.begin(), data.end(), [&] { return static_cast<char>(rd()); });
+
+        {
+            ByteStream stream{3001};
+            pipe_through(stream, 3001, data);
+        }
+
+        {
+            PipeByteStream stream{8192};
+            pipe_through(stream, 8192, data);
+
+            stream.write("abcdef");
+            stream.pop_output(2);
+            if (stream.peek_output(3) != "cde" or stream.read(10) != "cdef" or not stream.buffer_empty()) {
+                throw runtime_error("PipeByteStream write/pop/peek/read mismatch");
+            }
+        }
+
+        // 多次小splice占满槽位后，写入不能抛异常，剩余容量也应反映槽位
+        {
+            PipeByteStream stream{65536};
+            auto [in_w, in_r] = socket_pair();
+            const string chunk(10, 'x');
+            size_t spliced = 0;
+            while (stream.remaining_capacity() > 0) {
+                in_w.write(chunk);
+                const size_t n = stream.write_from(in_r, chunk.size());
+                if (n != chunk.size()) {
+                    throw runtime_error("write_from accepted " + to_string(n) + " bytes with capacity remaining");
+                }
+                spliced += n;
+            }
+            if (spliced > 64 * chunk.size()) {
+                throw runtime_error("remaining_capacity ignored the partly filled slots");
+            }
+            for (unsigned i = 0; i < 4; i++) {
+                if (stream.write("hello") != 0) {
+                    throw runtime_error("write to a pipe with no free slots should accept nothing");
+                }
+            }
+            if (stream.read(spliced) != string(spliced, 'x') or stream.remaining_capacity() != 65536) {
+                throw runtime_error("reading should free every slot");
+            }
+
+            // write(2)写入的数据可以追加到最后一个槽位
+            string expected;
+            for (unsigned i = 0; i < 1000; i++) {
+                if (stream.write("hello") != 5) {
+                    throw runtime_error("small writes should share slots");
+                }
+                expected += "hello";
+            }
+            if (stream.read(expected.size()) != expected) {
+                throw runtime_error("small writes were corrupted");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
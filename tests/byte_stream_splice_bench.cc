@@ -0,0 +1,92 @@
+#include "byte_stream.hh"
+#include "pipe_byte_stream.hh"
+#include "socket.hh"
+#include "util.hh"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+
+using namespace std;
+
+static constexpr size_t STREAM_CAPACITY = 1024 * 1024;
+static constexpr size_t CHUNK = 64 * 1024;
+
+static pair<LocalStreamSocket, LocalStreamSocket> socket_pair() {
+    array<int, 2> fds{};
+    SystemCall("socketpair", ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()));
+    return {LocalStreamSocket{FileDescriptor(fds[0])}, LocalStreamSocket{FileDescriptor(fds[1])}};
+}
+
+//! Move `total` bytes source -> socket pair -> `stream` -> socket pair -> sink, and time the middle part
+template <typename StreamT>
+static double transfer_gbps(StreamT &stream, const size_t total) {
+    auto [src_w, src_r] = socket_pair();
+    auto [dst_w, dst_r] = socket_pair();
+
+    thread source([&src_w = src_w, total] {
+        const string chunk(CHUNK, 'x');
+        for (size_t sent = 0; sent < total; sent += CHUNK) {
+            src_w.write(string_view(chunk).substr(0, min(CHUNK, total - sent)));
+        }
+        src_w.shutdown(SHUT_WR);
+    });
+
+    size_t received = 0;
+    thread sink([&dst_r = dst_r, &received] {
+        string buf;
+        while (not dst_r.eof()) {
+            dst_r.read(buf, CHUNK);
+            received += buf.size();
+        }
+    });
+
+    const auto start = chrono::steady_clock::now();
+    while (not src_r.eof() or not stream.buffer_empty()) {
+        if (not src_r.eof() and stream.remaining_capacity() > 0) {
+            stream.write_from(src_r, CHUNK);
+        }
+        if (not stream.buffer_empty()) {
+            stream.read_into(dst_w, CHUNK);
+        }
+    }
+    dst_w.shutdown(SHUT_WR);
+    source.join();
+    sink.join();
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    if (received != total) {
+        throw runtime_error("sink received " + to_string(received) + " bytes, expected " + to_string(total));
+    }
+    return 8.0 * total / elapsed.count() / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    try {
+        const size_t megabytes = argc > 1 ? stoul(argv[1]) : 1024;
+        const size_t total = megabytes * 1024 * 1024;
+
+        ByteStream ring{STREAM_CAPACITY};
+        const double ring_gbps = transfer_gbps(ring, total);
+
+        PipeByteStream pipe{STREAM_CAPACITY};
+        const double pipe_gbps = transfer_gbps(pipe, total);
+
+        cout << fixed << setprecision(2);
+        cout << megabytes << " MiB over LocalStreamSocket pairs:\n";
+        cout << "  ByteStream (readv/writev + memcpy): " << ring_gbps << " Gbit/s\n";
+        cout << "  PipeByteStream (splice):            " << pipe_gbps << " Gbit/s\n";
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
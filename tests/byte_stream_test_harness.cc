@@ -89,9 +89,16 @@ Write &Write::with_bytes_written(const size_t bytes_written) {
     _bytes_written = bytes_written;
     return *this;
 }
-std::string Write::description() const { return "write \"" + _data + "\" to the stream"; }
+Write &Write::by_rvalue() {
+    _by_rvalue = true;
+    return *this;
+}
+std::string Write::description() const {
+    return "write \"" + _data.substr(0, 16) + (_data.size() > 16 ? "..." : "") + "\" to the stream" +
+           (_by_rvalue ? " by rvalue" : "");
+}
 void Write::execute(ByteStream &bs) const {
-    auto bytes_written = bs.write(_data);
+    auto bytes_written = _by_rvalue ? bs.write(std::string(_data)) : bs.write(_data);
     if (_bytes_written and bytes_written != _bytes_written.value()) {
         throw ByteStreamExpectationViolation::property("bytes_written", _bytes_written.value(), bytes_written);
     }
@@ -182,3 +189,20 @@ void Peek::execute(ByteStream &bs) const {
                                              output + "\"");
     }
 }
+
+// PeekViews
+PeekViews::PeekViews(const std::string &output, const size_t num_views) : _output(output), _num_views(num_views) {}
+std::string PeekViews::description() const {
+    return "\"" + _output + "\" at the front of the stream in " + to_string(_num_views) + " views";
+}
+void PeekViews::execute(ByteStream &bs) const {
+    const BufferViewList views = bs.peek_views(_output.size());
+    if (views.views().size() != _num_views) {
+        throw ByteStreamExpectationViolation::property("number of views", _num_views, views.views().size());
+    }
+    auto output = views.concatenate();
+    if (output != _output) {
+        throw ByteStreamExpectationViolation("Expected \"" + _output +
+                                             "\" in views at the front of the stream, but found \"" + output + "\"");
+    }
+}
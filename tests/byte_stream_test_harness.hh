@@ -49,9 +49,11 @@ struct EndInput : public ByteStreamAction {
 struct Write : public ByteStreamAction {
     std::string _data;
     std::optional<size_t> _bytes_written{};
+    bool _by_rvalue = false;
 
     Write(const std::string &data);
     Write &with_bytes_written(const size_t bytes_written);
+    Write &by_rvalue();
     std::string description() const override;
     void execute(ByteStream &) const override;
 };
@@ -128,6 +130,15 @@ struct Peek : public ByteStreamExpectation {
     void execute(ByteStream &) const override;
 };
 
+struct PeekViews : public ByteStreamExpectation {
+    std::string _output;
+    size_t _num_views;
+
+    PeekViews(const std::string &output, const size_t num_views);
+    std::string description() const override;
+    void execute(ByteStream &) const override;
+};
+
 class ByteStreamTestHarness {
     std::string _test_name;
     ByteStream _byte_stream;
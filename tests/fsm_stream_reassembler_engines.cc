@@ -0,0 +1,146 @@
+#include "byte_stream.hh"
+#include "fsm_stream_reassembler_harness.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace std;
+
+static constexpr unsigned NREPS = 32;
+static constexpr unsigned NSEGS = 256;
+static constexpr unsigned MAX_SEG_LEN = 700;
+
+using Engine = StreamReassembler::Engine;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // 固定场景：环绕、重叠和容量限制
+        for (const Engine engine : {Engine::Map, Engine::Bitmap}) {
+            {
+                ReassemblerTestHarness test{8, engine};
+
+                test.execute(SubmitSegment{"abc", 0});
+                test.execute(BytesAvailable("abc"));
+                test.execute(SubmitSegment{"ghijkl", 6});
+                test.execute(UnassembledBytes(5));
+                test.execute(SubmitSegment{"def", 3});
+                test.execute(BytesAssembled(11));
+                test.execute(BytesAvailable("defghijk"));
+                test.execute(SubmitSegment{"klmnopqr", 10}.with_eof(true));
+                test.execute(BytesAssembled(18));
+                test.execute(BytesAvailable("lmnopqr"));
+                test.execute(AtEof{});
+            }
+
+            {
+                ReassemblerTestHarness test{70, engine};
+
+                test.execute(SubmitSegment{string(64, 'b'), 3});
+                test.execute(SubmitSegment{"c", 2});
+                test.execute(UnassembledBytes(65));
+                test.execute(SubmitSegment{"bb", 66});
+                test.execute(UnassembledBytes(66));
+                test.execute(SubmitSegment{"aa", 0});
+                test.execute(BytesAssembled(68));
+                test.execute(UnassembledBytes(0));
+                test.execute(BytesAvailable("aac" + string(65, 'b')));
+            }
+
+            // 恰好落在窗口边缘的空子串仍然带来eof
+            {
+                ReassemblerTestHarness test{2, engine};
+
+                test.execute(SubmitSegment{"ab", 0});
+                test.execute(SubmitSegment{"", 2}.with_eof(true));
+                test.execute(BytesAssembled(2));
+                test.execute(BytesAvailable("ab"));
+                test.execute(AtEof{});
+            }
+
+            // 超出窗口的数据不能带来eof
+            {
+                ReassemblerTestHarness test{2, engine};
+
+                test.execute(SubmitSegment{"abc", 0}.with_eof(true));
+                test.execute(BytesAvailable("ab"));
+                test.execute(NotAtEof{});
+                test.execute(SubmitSegment{"c", 2}.with_eof(true));
+                test.execute(BytesAvailable("c"));
+                test.execute(AtEof{});
+            }
+        }
+
+        // 两种引擎（以及Buffer版本的push_substring）在随机乱序、重叠、小容量下的行为应一致
+        for (unsigned rep_no = 0; rep_no < NREPS; ++rep_no) {
+            const size_t capacity = 1 + rd() % (4 * MAX_SEG_LEN);
+            StreamReassembler map_engine{capacity, Engine::Map};
+            StreamReassembler bitmap_engine{capacity, Engine::Bitmap};
+            StreamReassembler buffer_pushes{capacity};
+
+            vector<tuple<size_t, size_t>> seq_size;
+            size_t offset = 0;
+            for (unsigned i = 0; i < NSEGS; ++i) {
+                const size_t size = 1 + (rd() % (MAX_SEG_LEN - 1));
+                const size_t offs = min(offset, static_cast<size_t>(rd()) % 300);
+                seq_size.emplace_back(offset - offs, size + offs);
+                offset += size;
+            }
+
+            string d(offset, 0);
+            generate(d.begin(), d.end(), [&] { return rd(); });
+
+            string map_result, bitmap_result, buffer_result;
+            while (map_result.size() < offset) {
+                // 每轮打乱后全部发送一遍，并读出一部分
+                shuffle(seq_size.begin(), seq_size.end(), rd);
+                for (auto [off, sz] : seq_size) {
+                    const string dd = d.substr(off, sz);
+                    map_engine.push_substring(dd, off, off + sz == offset);
+                    bitmap_engine.push_substring(dd, off, off + sz == offset);
+                    buffer_pushes.push_substring(Buffer(string(dd)), off, off + sz == offset);
+
+                    if (map_engine.unassembled_bytes() != bitmap_engine.unassembled_bytes() or
+                        map_engine.unassembled_bytes() != buffer_pushes.unassembled_bytes() or
+                        map_engine.stream_out().bytes_written() != bitmap_engine.stream_out().bytes_written() or
+                        map_engine.stream_out().bytes_written() != buffer_pushes.stream_out().bytes_written()) {
+                        throw runtime_error("engines disagree on the number of assembled bytes");
+                    }
+                    if (map_engine.sack_blocks(4) != bitmap_engine.sack_blocks(4)) {
+                        throw runtime_error("engines disagree on SACK blocks");
+                    }
+
+                    const size_t n = rd() % (capacity + 1);
+                    map_result += map_engine.stream_out().read(n);
+                    bitmap_result += bitmap_engine.stream_out().read(n);
+                    buffer_result += buffer_pushes.stream_out().read(n);
+                }
+            }
+
+            if (map_result != d or bitmap_result != d or buffer_result != d) {
+                throw runtime_error("content of RX bytes is incorrect");
+            }
+            if (not map_engine.stream_out().eof() or not bitmap_engine.stream_out().eof()) {
+                throw runtime_error("stream did not reach EOF");
+            }
+            if (not map_engine.empty() or not bitmap_engine.empty()) {
+                throw runtime_error("reassembler not empty at EOF");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
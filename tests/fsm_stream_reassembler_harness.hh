@@ -10,6 +10,7 @@
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 // 报错
 class ReassemblerExpectationViolation : public std::runtime_error {
@@ -87,6 +88,35 @@ struct BytesAssembled : public ReassemblerExpectation {
     }
 };
 
+// 判断sack_blocks(max_blocks)返回的区间是否与预期一致
+struct SackBlocks : public ReassemblerExpectation {
+    std::vector<StreamReassembler::SackBlock> _blocks;
+    size_t _max_blocks;
+
+    SackBlocks(std::vector<StreamReassembler::SackBlock> blocks, size_t max_blocks = 4)
+        : _blocks(std::move(blocks)), _max_blocks(max_blocks) {}
+
+    static std::string to_string(const std::vector<StreamReassembler::SackBlock> &blocks) {
+        std::ostringstream ss;
+        for (const auto &b : blocks) {
+            ss << "[" << b.begin << ", " << b.end << ") ";
+        }
+        return ss.str();
+    }
+
+    std::string description() const {
+        return "sack_blocks(" + std::to_string(_max_blocks) + ") = " + to_string(_blocks);
+    }
+
+    void execute(StreamReassembler &reassembler) const {
+        const auto actual = reassembler.sack_blocks(_max_blocks);
+        if (actual != _blocks) {
+            throw ReassemblerExpectationViolation("The reassembler was expected to report SACK blocks " +
+                                                  to_string(_blocks) + "but reported " + to_string(actual));
+        }
+    }
+};
+
 // 判断已写入但尚未重新组装的子字符串字节数是否等于bytes
 struct UnassembledBytes : public ReassemblerExpectation {
     size_t _bytes;
@@ -175,8 +205,11 @@ class ReassemblerTestHarness {
     std::vector<std::string> steps_executed;
 
   public:
-    ReassemblerTestHarness(const size_t capacity) : reassembler(capacity), steps_executed() {
-        steps_executed.emplace_back("Initialized (capacity = " + std::to_string(capacity) + ")");
+    ReassemblerTestHarness(const size_t capacity,
+                           const StreamReassembler::Engine engine = StreamReassembler::Engine::Map)
+        : reassembler(capacity, engine), steps_executed() {
+        steps_executed.emplace_back("Initialized (capacity = " + std::to_string(capacity) + ", engine = " +
+                                    (engine == StreamReassembler::Engine::Map ? "map" : "bitmap") + ")");
     }
 
     void execute(const ReassemblerTestStep &step) {
@@ -0,0 +1,107 @@
+#include "byte_stream.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+using Policy = StreamReassembler::EvictionPolicy;
+static constexpr size_t F = StreamReassembler::FRAGMENT_OVERHEAD;
+
+static void check(const bool cond, const string &what) {
+    if (not cond) {
+        throw runtime_error(what);
+    }
+}
+
+int main() {
+    try {
+        // 默认无限制，只统计
+        {
+            StreamReassembler r{65000};
+            for (size_t i = 1; i < 200; i += 2) {
+                r.push_substring("x", i, false);
+            }
+            const auto stats = r.memory_stats();
+            check(stats.fragments == 100, "fragments should be counted");
+            check(stats.payload_bytes == 100, "payload bytes should be counted");
+            check(stats.overhead_bytes == 100 * F, "overhead should be counted per fragment");
+            check(r.memory_usage() == 100 * (1 + F), "usage is payload plus overhead");
+            check(stats.evictions == 0, "nothing should be evicted without a limit");
+        }
+
+        // 丢弃最远的分片
+        {
+            StreamReassembler r{65000};
+            r.set_memory_limit(2 * (1 + F), Policy::DropFarthest);
+            r.push_substring("a", 2, false);
+            r.push_substring("b", 4, false);
+            r.push_substring("c", 6, false);
+            check(r.unassembled_bytes() == 2, "farthest fragment should be dropped");
+            check(r.memory_stats().evictions == 1 and r.memory_stats().evicted_bytes == 1, "eviction counters");
+            r.push_substring("z", 0, false);
+            r.push_substring("y", 1, false);
+            r.push_substring("y", 3, false);
+            check(r.stream_out().read(10) == "zyayb", "dropped fragment should not be assembled");
+        }
+
+        // 丢弃最新的分片
+        {
+            StreamReassembler r{65000};
+            r.set_memory_limit(2 * (1 + F), Policy::DropNewest);
+            r.push_substring("c", 6, false);
+            r.push_substring("b", 4, false);
+            r.push_substring("a", 2, false);
+            check(r.unassembled_bytes() == 2, "newest fragment should be dropped");
+            r.push_substring("01a3b5", 0, false);
+            check(r.stream_out().read(10) == "01a3b5c", "older fragments should survive");
+            check(r.empty(), "everything should be assembled");
+        }
+
+        // 合并相邻分片，减少开销而不丢数据
+        {
+            StreamReassembler r{65000};
+            r.set_memory_limit(3 + F, Policy::Coalesce);
+            r.push_substring("a", 1, false);
+            r.push_substring("b", 2, false);
+            r.push_substring("c", 3, false);
+            const auto stats = r.memory_stats();
+            check(stats.fragments == 1 and stats.payload_bytes == 3, "touching fragments should be merged");
+            check(stats.coalesced == 2 and stats.evictions == 0, "coalesce counters");
+            r.push_substring("0", 0, true);
+            r.push_substring("d", 4, true);
+            check(r.stream_out().read(10) == "0abcd", "merged fragment should be assembled");
+            check(r.stream_out().eof(), "stream should finish");
+        }
+
+        // 降低限制时立即生效
+        {
+            StreamReassembler r{65000};
+            for (size_t i = 1; i < 20; i += 2) {
+                r.push_substring("xy", i, false);
+            }
+            r.set_memory_limit(3 * (2 + F));
+            check(r.memory_stats().fragments == 3, "lowering the limit should evict");
+            check(r.memory_usage() <= 3 * (2 + F), "usage should be within the limit");
+        }
+
+        // Bitmap引擎的内存固定，不受限制影响
+        {
+            StreamReassembler r{8, StreamReassembler::Engine::Bitmap};
+            r.set_memory_limit(0);
+            r.push_substring("b", 1, false);
+            r.push_substring("d", 3, false);
+            check(r.unassembled_bytes() == 2 and r.memory_stats().evictions == 0, "bitmap engine ignores the limit");
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
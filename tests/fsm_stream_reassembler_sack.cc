@@ -0,0 +1,66 @@
+#include "byte_stream.hh"
+#include "fsm_stream_reassembler_harness.hh"
+#include "stream_reassembler.hh"
+#include "util.hh"
+
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+using Engine = StreamReassembler::Engine;
+
+int main() {
+    try {
+        for (const Engine engine : {Engine::Map, Engine::Bitmap}) {
+            {
+                ReassemblerTestHarness test{65000, engine};
+
+                test.execute(SackBlocks({}));
+                test.execute(SubmitSegment{"abc", 0});
+                test.execute(SackBlocks({}));
+                test.execute(SubmitSegment{"ef", 4});
+                test.execute(SackBlocks({{4, 6}}));
+                test.execute(SubmitSegment{"ijk", 8});
+                test.execute(SubmitSegment{"mn", 12});
+                test.execute(SubmitSegment{"q", 16});
+                test.execute(SubmitSegment{"s", 18});
+                test.execute(SackBlocks({{18, 19}, {16, 17}, {12, 14}, {8, 11}}));
+                test.execute(SackBlocks({{18, 19}, {16, 17}}, 2));
+                test.execute(SackBlocks({}, 0));
+
+                // 首尾相接的分片合并为一个块
+                test.execute(SubmitSegment{"l", 11});
+                test.execute(SackBlocks({{18, 19}, {16, 17}, {8, 14}, {4, 6}}));
+                test.execute(SubmitSegment{"g", 6});
+                test.execute(SubmitSegment{"h", 7});
+                test.execute(SackBlocks({{18, 19}, {16, 17}, {4, 14}}, 3));
+
+                // 填补空洞后块消失
+                test.execute(SubmitSegment{"d", 3});
+                test.execute(SackBlocks({{18, 19}, {16, 17}}));
+                test.execute(BytesAvailable("abcdefghijklmn"));
+            }
+
+            // 环形缓冲区回绕时的块
+            {
+                ReassemblerTestHarness test{10, engine};
+
+                test.execute(SubmitSegment{"abcdef", 0});
+                test.execute(BytesAvailable("abcdef"));
+                test.execute(SubmitSegment{"h", 7});
+                test.execute(SubmitSegment{"jklm", 9});
+                test.execute(SackBlocks({{9, 13}, {7, 8}}));
+                test.execute(SubmitSegment{"p", 15});
+                test.execute(SackBlocks({{15, 16}, {9, 13}, {7, 8}}));
+                test.execute(SackBlocks({{15, 16}}, 1));
+            }
+        }
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -13,6 +13,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <vector>
 
 struct ReceiverTestStep {
     virtual std::string to_string() const { return "ReceiverTestStep"; }
@@ -88,6 +89,46 @@ struct ExpectWindow : public ReceiverExpectation {
 };
 
 // 已经收到但还未写入的字节数判断
+// 判断接收方报告的SACK块
+struct ExpectSackBlocks : public ReceiverExpectation {
+    TCPSackList _blocks;
+
+    ExpectSackBlocks(TCPSackList blocks) : _blocks(blocks) {}
+
+    static std::string blocks_string(const TCPSackList &blocks) {
+        std::ostringstream ss;
+        for (const auto &b : blocks) {
+            ss << "[" << b.left.raw_value() << ", " << b.right.raw_value() << ") ";
+        }
+        return ss.str();
+    }
+
+    std::string description() const override { return "SACK blocks " + blocks_string(_blocks); }
+
+    void execute(TCPReceiver &receiver) const override {
+        const auto actual = receiver.sack_blocks();
+        if (actual != _blocks) {
+            throw ReceiverExpectationViolation("The TCPReceiver reported SACK blocks " + blocks_string(actual) +
+                                               "but was expected to report " + blocks_string(_blocks));
+        }
+    }
+};
+
+// 是否应立即发送ACK
+struct ExpectAckDue : public ReceiverExpectation {
+    bool _due;
+
+    ExpectAckDue(bool due) : _due(due) {}
+    std::string description() const override { return _due ? "an ACK is due" : "no ACK is due"; }
+
+    void execute(TCPReceiver &receiver) const override {
+        if (receiver.ack_due() != _due) {
+            throw ReceiverExpectationViolation(_due ? "The TCPReceiver should have asked for an ACK"
+                                                    : "The TCPReceiver asked for an ACK, but should have delayed it");
+        }
+    }
+};
+
 struct ExpectUnassembledBytes : public ReceiverExpectation {
     size_t _n_bytes;
 
@@ -204,6 +245,7 @@ struct SegmentArrives : public ReceiverAction {
     WrappingInt32 ackno{0};
     uint16_t win{};
     std::string data{};
+    bool sack_permitted{};
     std::optional<Result> result{};
 
     // 接收确认号
@@ -247,6 +289,12 @@ struct SegmentArrives : public ReceiverAction {
         return *this;
     }
 
+    // SYN中提供SACK-permitted选项
+    SegmentArrives &with_sack_permitted() {
+        sack_permitted = true;
+        return *this;
+    }
+
     // 实际传输数据
     SegmentArrives &with_data(std::string data_) {
         data = data_;
@@ -270,6 +318,7 @@ struct SegmentArrives : public ReceiverAction {
         seg.header().ackno = ackno;
         seg.header().seqno = seqno;
         seg.header().win = win;
+        seg.header().options.sack_permitted = sack_permitted;
         return seg;
     }
 
@@ -310,6 +359,21 @@ struct SegmentArrives : public ReceiverAction {
     }
 };
 
+// 已发送ACK
+struct AckSent : public ReceiverAction {
+    std::string description() const override { return "an ACK is sent"; }
+    void execute(TCPReceiver &receiver) const override { receiver.ack_sent(); }
+};
+
+// 时间流逝
+struct ReceiverTick : public ReceiverAction {
+    size_t _ms;
+
+    ReceiverTick(size_t ms) : _ms(ms) {}
+    std::string description() const override { return std::to_string(_ms) + " ms pass"; }
+    void execute(TCPReceiver &receiver) const override { receiver.tick(_ms); }
+};
+
 // TCP接收方测试类
 class TCPReceiverTestHarness {
     TCPReceiver receiver;
@@ -322,6 +386,13 @@ class TCPReceiverTestHarness {
            << "capacity=" << capacity << ")";
         steps_executed.emplace_back(ss.str());
     }
+
+    TCPReceiverTestHarness(const TCPConfig &config) : receiver(config), steps_executed() {
+        std::ostringstream ss;
+        ss << "Initialized with ("
+           << "capacity=" << config.recv_capacity << ", sack=" << config.sack << ")";
+        steps_executed.emplace_back(ss.str());
+    }
     void execute(const ReceiverTestStep &step) {
         try {
             step.execute(receiver);
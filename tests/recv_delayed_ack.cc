@@ -0,0 +1,99 @@
+#include "receiver_harness.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+        // 每两个满长度段确认一次
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPConfig cfg;
+            cfg.delayed_ack = true;
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+            test.execute(ExpectAckDue{true});
+            test.execute(AckSent{});
+            test.execute(ExpectAckDue{false});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data(string(mss, 'a')));
+            test.execute(ExpectAckDue{false});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1 + mss).with_data(string(mss, 'b')));
+            test.execute(ExpectAckDue{true});
+            test.execute(ExpectAckno{WrappingInt32{isn + 1 + 2 * static_cast<uint32_t>(mss)}});
+            test.execute(AckSent{});
+            test.execute(ExpectAckDue{false});
+        }
+
+        // 小段在超时后确认
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPConfig cfg;
+            cfg.delayed_ack = true;
+            cfg.delayed_ack_timeout = 40;
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+            test.execute(AckSent{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("abc"));
+            test.execute(ReceiverTick{30});
+            test.execute(SegmentArrives{}.with_seqno(isn + 4).with_data("def"));
+            test.execute(ReceiverTick{9});
+            test.execute(ExpectAckDue{false});
+            // 计时从第一个未确认的段开始
+            test.execute(ReceiverTick{1});
+            test.execute(ExpectAckDue{true});
+            test.execute(ExpectAckno{WrappingInt32{isn + 7}});
+            test.execute(AckSent{});
+            test.execute(ReceiverTick{100});
+            test.execute(ExpectAckDue{false});
+        }
+
+        // 乱序、填补空洞和FIN立即确认
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPConfig cfg;
+            cfg.delayed_ack = true;
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+            test.execute(AckSent{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 3).with_data("c"));
+            test.execute(ExpectAckDue{true});
+            test.execute(AckSent{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("a"));
+            test.execute(ExpectAckDue{true});
+            test.execute(AckSent{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 2).with_data("b"));
+            test.execute(ExpectAckDue{true});
+            test.execute(AckSent{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 4).with_data("d"));
+            test.execute(ExpectAckDue{false});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_fin());
+            test.execute(ExpectAckDue{true});
+        }
+
+        // 未启用时每个段都需要确认
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{TCPConfig{}};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+            test.execute(AckSent{});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("a"));
+            test.execute(ExpectAckDue{true});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
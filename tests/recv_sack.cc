@@ -0,0 +1,71 @@
+#include "receiver_harness.hh"
+#include "util.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // SACK negotiated: out-of-order data is reported, most recent block first
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPConfig cfg;
+            cfg.sack = true;
+            TCPReceiverTestHarness test{cfg};
+            test.execute(ExpectSackBlocks{{}});
+            test.execute(SegmentArrives{}.with_syn().with_sack_permitted().with_seqno(isn));
+            test.execute(ExpectSackBlocks{{}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 2).with_data("b"));
+            test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 2}, WrappingInt32{isn + 3}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 6).with_data("fg"));
+            test.execute(SegmentArrives{}.with_seqno(isn + 4).with_data("d"));
+            test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 4}, WrappingInt32{isn + 5}},
+                                           {WrappingInt32{isn + 6}, WrappingInt32{isn + 8}},
+                                           {WrappingInt32{isn + 2}, WrappingInt32{isn + 3}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 3).with_data("c"));
+            test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 2}, WrappingInt32{isn + 5}},
+                                           {WrappingInt32{isn + 6}, WrappingInt32{isn + 8}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 1).with_data("a"));
+            test.execute(ExpectAckno{WrappingInt32{isn + 5}});
+            test.execute(ExpectSackBlocks{{{WrappingInt32{isn + 6}, WrappingInt32{isn + 8}}}});
+            test.execute(SegmentArrives{}.with_seqno(isn + 5).with_data("e"));
+            test.execute(ExpectSackBlocks{{}});
+            test.execute(ExpectBytes{"abcdefg"});
+        }
+
+        // Peer did not offer SACK
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPConfig cfg;
+            cfg.sack = true;
+            TCPReceiverTestHarness test{cfg};
+            test.execute(SegmentArrives{}.with_syn().with_seqno(isn));
+            test.execute(SegmentArrives{}.with_seqno(isn + 2).with_data("b"));
+            test.execute(ExpectUnassembledBytes{1});
+            test.execute(ExpectSackBlocks{{}});
+        }
+
+        // SACK not enabled locally
+        {
+            uint32_t isn = uniform_int_distribution<uint32_t>{0, UINT32_MAX}(rd);
+            TCPReceiverTestHarness test{TCPConfig{}};
+            test.execute(SegmentArrives{}.with_syn().with_sack_permitted().with_seqno(isn));
+            test.execute(SegmentArrives{}.with_seqno(isn + 2).with_data("b"));
+            test.execute(ExpectSackBlocks{{}});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,127 @@
+#include "segment_ring.hh"
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// 统计堆分配次数
+static size_t allocations = 0;
+
+void *operator new(size_t size) {
+    allocations++;
+    if (void *p = malloc(size)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+static void expect(const bool cond, const string &what) {
+    if (not cond) {
+        throw runtime_error(what);
+    }
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // 第一次push之前不分配
+        {
+            const size_t before = allocations;
+            SegmentRing ring{};
+            const bool allocated = allocations != before;
+            expect(ring.capacity() == 0 and not allocated, "an unused ring should not allocate");
+            ring.push(TCPSegment{});
+            expect(ring.capacity() == SegmentRing::MIN_CAPACITY, "the first push allocates MIN_CAPACITY slots");
+        }
+
+        // 环形队列：先进先出，满时扩容
+        {
+            SegmentRing ring{3};
+            expect(ring.capacity() == 4, "capacity rounds up to a power of two");
+            array<TCPSegment, 8> out{};
+            for (uint32_t round = 0; round < 3; round++) {
+                for (uint32_t i = 0; i < 6; i++) {
+                    TCPSegment seg;
+                    seg.header().seqno = WrappingInt32{round * 100 + i};
+                    ring.push(move(seg));
+                    expect(ring.back().header().seqno == WrappingInt32{round * 100 + i}, "back() is the newest");
+                }
+                expect(ring.size() == 6 and ring.front().header().seqno == WrappingInt32{round * 100},
+                       "front() is the oldest");
+                ring.pop();
+                expect(ring.drain(out.data(), 2) == 2, "partial drain");
+                expect(ring.drain(out.data() + 2, out.size()) == 3 and ring.empty(), "drain empties the ring");
+                for (uint32_t i = 0; i < 5; i++) {
+                    expect(out[i].header().seqno == WrappingInt32{round * 100 + i + 1}, "drain keeps the order");
+                }
+            }
+            expect(ring.capacity() == 8, "ring doubles when full");
+        }
+
+        // 发送端批量取出：与逐个pop得到相同的段，预热后不再分配
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.send_capacity = 64 * TCPConfig::MAX_PAYLOAD_SIZE;
+
+            TCPSender batched{cfg};
+            TCPSender single{cfg};
+            const string data(cfg.send_capacity, 'x');
+            array<TCPSegment, 32> batch{};
+            for (TCPSender *sender : {&batched, &single}) {
+                sender->fill_window();
+                TCPHeader ack;
+                ack.ack = true;
+                ack.ackno = isn + 1;
+                ack.win = 65535;
+                sender->ack_received(ack);
+                sender->stream_in().write(data);
+            }
+
+            // 只统计drain_segments本身的分配
+            single.fill_window();
+            batched.fill_window();
+            expect(batched.segments_out().size() == single.segments_out().size(), "same number of segments");
+            size_t total = 0, drain_allocations = 0;
+            while (true) {
+                const size_t before = allocations;
+                const size_t n = batched.drain_segments(batch.data(), batch.size());
+                drain_allocations += allocations - before;
+                if (n == 0) {
+                    break;
+                }
+                for (size_t i = 0; i < n; i++) {
+                    const TCPSegment &expected = single.segments_out().front();
+                    expect(batch[i].header() == expected.header() and
+                               batch[i].payload().str() == expected.payload().str(),
+                           "batched segment differs from the queued one");
+                    single.segments_out().pop();
+                }
+                total += n;
+            }
+            expect(drain_allocations == 0, "draining allocated " + to_string(drain_allocations) + " times");
+            expect(single.segments_out().empty() and batched.segments_out().empty() and total > 32,
+                   "both senders drained");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
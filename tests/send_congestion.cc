@@ -0,0 +1,192 @@
+#include "congestion_control.hh"
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static void expect_eq(const size_t actual, const size_t expected, const string &what) {
+    if (actual != expected) {
+        throw runtime_error(what + ": expected " + to_string(expected) + ", got " + to_string(actual));
+    }
+}
+
+static void expect_true(const bool cond, const string &what) {
+    if (not cond) {
+        throw runtime_error(what);
+    }
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t mss = 1000;
+
+        // NewReno: 慢启动、拥塞避免、丢包减半、超时回到一个MSS
+        {
+            NewRenoController reno{mss};
+            expect_eq(reno.cwnd(), 10 * mss, "NewReno initial window");
+            for (unsigned i = 0; i < 10; i++) {
+                reno.on_ack(0, 0, mss, 0);
+            }
+            expect_eq(reno.cwnd(), 20 * mss, "NewReno slow start");
+            reno.on_loss(0, 20 * mss);
+            expect_eq(reno.cwnd(), 10 * mss, "NewReno window after loss");
+            expect_eq(reno.ssthresh(), 10 * mss, "NewReno ssthresh after loss");
+            for (unsigned i = 0; i < 9; i++) {
+                reno.on_ack(0, 0, mss, 0);
+            }
+            expect_eq(reno.cwnd(), 10 * mss, "NewReno congestion avoidance before a full window");
+            reno.on_ack(0, 0, mss, 0);
+            expect_eq(reno.cwnd(), 11 * mss, "NewReno congestion avoidance after a full window");
+            reno.on_rto(0, 11 * mss);
+            expect_eq(reno.cwnd(), mss, "NewReno window after timeout");
+            expect_eq(reno.ssthresh(), 5500, "NewReno ssthresh after timeout");
+        }
+
+        // CUBIC: 乘性减小到0.7，之后沿三次曲线回到并超过原窗口
+        {
+            CubicController cubic{mss};
+            cubic.on_loss(0, 10 * mss);
+            expect_eq(cubic.cwnd(), 7 * mss, "CUBIC window after loss");
+
+            // 1秒RTT，每个RTT确认整个窗口
+            uint64_t now = 0;
+            auto one_rtt = [&] {
+                now += 1000;
+                const size_t segments = cubic.cwnd() / mss;
+                for (size_t i = 0; i < segments; i++) {
+                    cubic.on_ack(now, 0, mss, 0);
+                }
+            };
+            one_rtt();
+            one_rtt();
+            expect_true(cubic.cwnd() > 7 * mss and cubic.cwnd() < 10 * mss,
+                        "CUBIC should approach but not pass the old window before K, got " +
+                            to_string(cubic.cwnd()));
+            const size_t near_plateau = cubic.cwnd();
+            one_rtt();
+            one_rtt();
+            one_rtt();
+            expect_true(cubic.cwnd() > 10 * mss,
+                        "CUBIC should probe past the old window, got " + to_string(cubic.cwnd()));
+            expect_true(cubic.cwnd() - near_plateau > mss, "CUBIC should accelerate after the plateau");
+            cubic.on_rto(now, cubic.cwnd());
+            expect_eq(cubic.cwnd(), mss, "CUBIC window after timeout");
+        }
+
+        // BBR-lite: 100字节/毫秒的瓶颈链路，100毫秒传播时延
+        {
+            BBRLiteController bbr{mss};
+            const uint64_t prop_delay = 100;
+            const uint64_t serialization = 10;  // mss / (100 bytes/ms)
+            deque<pair<uint64_t, uint64_t>> acks{};  // (到达时间, ackno)
+            uint64_t next_seqno = 0, ackno = 0, link_free = 0;
+            for (uint64_t now = 0; now < 5000; now++) {
+                while (not acks.empty() and acks.front().first <= now) {
+                    const uint64_t acked = acks.front().second - ackno;
+                    ackno = acks.front().second;
+                    acks.pop_front();
+                    bbr.on_ack(now, ackno, acked, next_seqno - ackno);
+                }
+                while (next_seqno + mss - ackno <= bbr.cwnd()) {
+                    next_seqno += mss;
+                    bbr.on_send(now, next_seqno, next_seqno - ackno);
+                    link_free = max(link_free, now) + serialization;
+                    acks.emplace_back(link_free + prop_delay, next_seqno);
+                }
+            }
+            expect_true(not bbr.in_startup(), "BBR-lite should leave startup");
+            expect_true(bbr.min_rtt().has_value() and bbr.min_rtt().value() >= prop_delay + serialization and
+                            bbr.min_rtt().value() <= prop_delay + 2 * serialization,
+                        "BBR-lite min RTT estimate is off");
+            expect_true(bbr.bottleneck_bandwidth() > 90 and bbr.bottleneck_bandwidth() < 110,
+                        "BBR-lite bandwidth estimate is off: " + to_string(bbr.bottleneck_bandwidth()));
+            const double bdp = bbr.bottleneck_bandwidth() * bbr.min_rtt().value();
+            expect_true(bbr.cwnd() <= 2 * bdp + 1 and bbr.cwnd() >= bdp,
+                        "BBR-lite window should be about twice the BDP, got " + to_string(bbr.cwnd()));
+            bbr.on_rto(5000, 0);
+            expect_eq(bbr.cwnd(), mss, "BBR-lite window after timeout");
+        }
+
+        // 发送端：拥塞窗口限制在途字节数
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.send_capacity = 65535;
+            cfg.congestion_control = CongestionControl::NewReno;
+            const size_t iw = NewRenoController::INITIAL_WINDOW_SEGMENTS * TCPConfig::MAX_PAYLOAD_SIZE;
+
+            TCPSenderTestHarness test{"NewReno limits bytes in flight", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(65535));
+            test.execute(WriteBytes{string(65535, 'x')});
+            // SYN被确认后窗口增长1字节
+            test.execute(ExpectBytesInFlight{iw + 1});
+
+            // 确认一个MSS：慢启动中在途字节数增加一个MSS
+            test.execute(AckReceived{WrappingInt32{isn + 1 + TCPConfig::MAX_PAYLOAD_SIZE}}.with_win(65535));
+            test.execute(ExpectBytesInFlight{iw + 1 + TCPConfig::MAX_PAYLOAD_SIZE});
+
+            // 超时后窗口为一个MSS，确认重传段后仍不发送新数据
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 2 * TCPConfig::MAX_PAYLOAD_SIZE}}.with_win(65535));
+            test.execute(ExpectBytesInFlight{iw + 1});
+        }
+
+        // 零窗口之后窗口重新打开，再发生超时时拥塞窗口仍回到一个MSS
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.send_capacity = 65535;
+            cfg.congestion_control = CongestionControl::NewReno;
+
+            TCPSender sender{cfg};
+            auto ack = [&](const uint16_t win) {
+                TCPHeader header;
+                header.ack = true;
+                header.ackno = isn + 1;
+                header.win = win;
+                sender.ack_received(header);
+            };
+            sender.fill_window();
+            ack(0);
+            ack(65535);
+            sender.stream_in().write(string(10000, 'x'));
+            sender.fill_window();
+            expect_true(sender.bytes_in_flight() > TCPConfig::MAX_PAYLOAD_SIZE, "window should be open again");
+            sender.tick(cfg.rt_timeout);
+            expect_eq(sender.congestion_controller()->cwnd(), TCPConfig::MAX_PAYLOAD_SIZE,
+                      "NewReno window after a timeout that follows a zero window");
+        }
+
+        // 不启用拥塞控制时只受接收窗口限制
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.send_capacity = 65535;
+
+            TCPSenderTestHarness test{"no congestion control", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(65535));
+            test.execute(WriteBytes{string(65535, 'x')});
+            test.execute(ExpectBytesInFlight{65535});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
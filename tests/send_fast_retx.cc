@@ -0,0 +1,203 @@
+#include "sender_harness.hh"
+#include "tcp_receiver.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+// 模拟单向时延为delay的链路，丢弃指定序号的段各一次，返回全部数据被确认所需的时间
+static uint64_t transfer_time(const TCPConfig &cfg, const size_t len, set<uint64_t> drop_seqnos) {
+    const uint64_t delay = 5;
+    TCPSender sender{cfg};
+    TCPReceiver receiver{cfg};
+    deque<pair<uint64_t, TCPSegment>> to_receiver{};
+    deque<pair<uint64_t, TCPHeader>> to_sender{};
+
+    string data(len, 'x');
+    sender.fill_window();
+    for (uint64_t now = 0; now < 60000; now++) {
+        while (not to_sender.empty() and to_sender.front().first <= now) {
+            sender.ack_received(to_sender.front().second);
+            to_sender.pop_front();
+        }
+        if (not data.empty()) {
+            data.erase(0, sender.stream_in().write(data));
+            if (data.empty()) {
+                sender.stream_in().end_input();
+            }
+        }
+        sender.fill_window();
+        while (not sender.segments_out().empty()) {
+            TCPSegment &seg = sender.segments_out().front();
+            const uint64_t seqno = seg.header().seqno.raw_value();
+            if (not drop_seqnos.erase(seqno)) {
+                to_receiver.emplace_back(now + delay, seg);
+            }
+            sender.segments_out().pop();
+        }
+        while (not to_receiver.empty() and to_receiver.front().first <= now) {
+            receiver.segment_received(to_receiver.front().second);
+            to_receiver.pop_front();
+            TCPHeader ack;
+            ack.ack = true;
+            ack.ackno = receiver.ackno().value();
+            ack.win = receiver.window_advertisement();
+            to_sender.emplace_back(now + delay, ack);
+        }
+        if (sender.stream_in().eof() and sender.bytes_in_flight() == 0 and sender.next_seqno_absolute() > 0) {
+            return now;
+        }
+        sender.tick(1);
+    }
+    throw runtime_error("transfer did not finish");
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // 第三个重复确认触发快速重传
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"fast retransmit on the third duplicate ACK", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            for (const string s : {"a", "b", "c", "d", "e"}) {
+                test.execute(WriteBytes{string(s)});
+                test.execute(ExpectSegment{}.with_data(s));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 2}});
+            test.execute(AckReceived{WrappingInt32{isn + 2}});
+            test.execute(AckReceived{WrappingInt32{isn + 2}});
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 2}});
+            test.execute(ExpectSegment{}.with_seqno(isn + 2).with_data("b"));
+            test.execute(ExpectNoSegment{});
+            // 恢复期间更多的重复确认不再重传
+            test.execute(AckReceived{WrappingInt32{isn + 2}});
+            test.execute(ExpectNoSegment{});
+
+            // 部分确认：立即重传下一个空洞
+            test.execute(AckReceived{WrappingInt32{isn + 4}});
+            test.execute(ExpectSegment{}.with_seqno(isn + 4).with_data("d"));
+            test.execute(ExpectNoSegment{});
+
+            // 完全确认后退出恢复
+            test.execute(AckReceived{WrappingInt32{isn + 6}});
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectState{TCPSenderStateSummary::SYN_ACKED});
+        }
+
+        // 窗口更新不算重复确认，默认不启用
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"window updates are not duplicate ACKs", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(3));
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(4));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(5));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(6));
+            test.execute(ExpectNoSegment{});
+
+            cfg.fast_retransmit = false;
+            TCPSenderTestHarness off{"no fast retransmit by default", cfg};
+            off.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            off.execute(AckReceived{WrappingInt32{isn + 1}});
+            off.execute(WriteBytes{"ab"});
+            off.execute(ExpectSegment{}.with_data("ab"));
+            for (unsigned i = 0; i < 4; i++) {
+                off.execute(AckReceived{WrappingInt32{isn + 1}});
+            }
+            off.execute(ExpectNoSegment{});
+        }
+
+        // 启用pacing时_paced中的段不算在途：不计重复确认，也不计入恢复点
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.fast_retransmit = true;
+            cfg.pacing = true;
+            const size_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+            cfg.pacing_rate = mss * 1000;
+
+            TCPSenderTestHarness test{"fast retransmit with pacing", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            test.execute(WriteBytes{string(4 * mss, 'x')});
+            test.execute(ExpectSegment{}.with_seqno(isn + 1).with_payload_size(mss));
+            test.execute(ExpectSegment{}.with_seqno(isn + 1 + mss).with_payload_size(mss));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{2 * mss});
+            for (unsigned i = 0; i < TCPConfig::DUPACK_THRESHOLD; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(60000));
+            }
+            test.execute(ExpectSegment{}.with_seqno(isn + 1).with_payload_size(mss));
+            test.execute(ExpectNoSegment{});
+
+            // 确认所有已发出的段即退出恢复
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 2 * mss}}.with_win(60000));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+            // 没有数据在途时的相同确认不是重复确认
+            for (unsigned i = 0; i < TCPConfig::DUPACK_THRESHOLD; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1 + 2 * mss}}.with_win(60000));
+            }
+            test.execute(ExpectNoSegment{});
+
+            test.execute(Tick{2});
+            test.execute(ExpectSegment{}.with_seqno(isn + 1 + 2 * mss).with_payload_size(mss));
+            test.execute(ExpectNoSegment{});
+            for (unsigned i = 1; i < TCPConfig::DUPACK_THRESHOLD; i++) {
+                test.execute(AckReceived{WrappingInt32{isn + 1 + 2 * mss}}.with_win(60000));
+            }
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 1 + 2 * mss}}.with_win(60000));
+            test.execute(ExpectSegment{}.with_seqno(isn + 1 + 2 * mss).with_payload_size(mss));
+            test.execute(ExpectNoSegment{});
+        }
+
+        // 丢包注入：恢复时间从RTO量级降到RTT量级
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            const uint32_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+            const set<uint64_t> drops{(isn + 1 + 2 * mss).raw_value(), (isn + 1 + 5 * mss).raw_value()};
+
+            const uint64_t slow = transfer_time(cfg, 30 * mss, drops);
+            cfg.fast_retransmit = true;
+            const uint64_t fast = transfer_time(cfg, 30 * mss, drops);
+            // RTT为10ms：快速重传应在10个RTT内完成
+            if (slow < TCPConfig::TIMEOUT_DFLT or fast >= 100) {
+                throw runtime_error("expected recovery in a few RTTs with fast retransmit: took " +
+                                    to_string(fast) + " ms, versus " + to_string(slow) + " ms without");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
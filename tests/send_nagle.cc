@@ -0,0 +1,105 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+// 直接调用cork/uncork
+struct Cork : public SenderAction {
+    bool _cork;
+
+    Cork(bool cork) : _cork(cork) {}
+    std::string description() const { return _cork ? "cork" : "uncork"; }
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (_cork) {
+            sender.cork();
+        } else {
+            sender.uncork();
+        }
+    }
+};
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+        // Nagle：有未确认数据时小段合并
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.nagle = true;
+
+            TCPSenderTestHarness test{"Nagle coalesces small writes", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(65000));
+            test.execute(WriteBytes{"a"});
+            test.execute(ExpectSegment{}.with_data("a"));
+            test.execute(WriteBytes{"b"});
+            test.execute(WriteBytes{"c"});
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_win(65000));
+            test.execute(ExpectSegment{}.with_data("bc"));
+
+            // 满长度段不等待
+            test.execute(WriteBytes{string(mss, 'x')});
+            test.execute(ExpectSegment{}.with_data(string(mss, 'x')));
+            test.execute(ExpectNoSegment{});
+
+            // 关闭时立即发送剩余数据
+            test.execute(WriteBytes{"d"}.with_end_input(true));
+            test.execute(ExpectSegment{}.with_data("d").with_fin(true));
+        }
+
+        // cork：满长度之前不发送，uncork时发送
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"cork holds partial segments", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(65000));
+            test.execute(Cork{true});
+            test.execute(WriteBytes{"hello "});
+            test.execute(WriteBytes{"world"});
+            test.execute(ExpectNoSegment{});
+            test.execute(Cork{false});
+            test.execute(ExpectSegment{}.with_data("hello world"));
+
+            test.execute(Cork{true});
+            test.execute(WriteBytes{string(mss + 3, 'y')});
+            test.execute(ExpectSegment{}.with_data(string(mss, 'y')));
+            test.execute(ExpectNoSegment{});
+            test.execute(Cork{false});
+            test.execute(ExpectSegment{}.with_data("yyy"));
+        }
+
+        // 默认每次写入都发送
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"no Nagle by default", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(65000));
+            test.execute(WriteBytes{"a"});
+            test.execute(ExpectSegment{}.with_data("a"));
+            test.execute(WriteBytes{"b"});
+            test.execute(ExpectSegment{}.with_data("b"));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
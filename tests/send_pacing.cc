@@ -0,0 +1,168 @@
+#include "pacer.hh"
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+static size_t drain(TCPSender &sender) {
+    size_t n = 0;
+    while (not sender.segments_out().empty()) {
+        sender.segments_out().pop();
+        n++;
+    }
+    return n;
+}
+
+static void expect_eq(const uint64_t actual, const uint64_t expected, const string &what) {
+    if (actual != expected) {
+        throw runtime_error(what + ": expected " + to_string(expected) + ", got " + to_string(actual));
+    }
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+        // 令牌桶：允许透支，透支部分按速率偿还
+        {
+            Pacer pacer{10};
+            pacer.set_rate(5);
+            pacer.consume(10);
+            expect_eq(pacer.ready(), false, "pacer with an empty bucket");
+            expect_eq(pacer.time_until_ready(), 1, "time until an empty bucket is ready");
+            pacer.advance(1);
+            expect_eq(pacer.ready(), true, "pacer after refilling");
+            pacer.consume(20);
+            expect_eq(pacer.time_until_ready(), 4, "time to repay an overdraft");
+            pacer.advance(3);
+            expect_eq(pacer.ready(), false, "pacer with a balance of zero");
+            pacer.advance(100);
+            pacer.consume(10);
+            expect_eq(pacer.ready(), false, "bucket capacity is the burst size");
+            pacer.set_rate(0);
+            expect_eq(pacer.ready(), true, "unpaced");
+        }
+
+        // 固定速率：每毫秒一个MSS
+        {
+            TCPConfig cfg;
+            cfg.fixed_isn = WrappingInt32{static_cast<uint32_t>(rd())};
+            cfg.pacing = true;
+            cfg.pacing_rate = mss * 1000;
+            TCPSender sender{cfg};
+            sender.fill_window();
+            expect_eq(drain(sender), 1, "SYN");
+            sender.ack_received(sender.next_seqno(), 65535);
+            sender.stream_in().write(string(10 * mss, 'x'));
+            sender.fill_window();
+            expect_eq(sender.bytes_in_flight(), 2 * mss, "held segments are not in flight");
+            expect_eq(drain(sender), 2, "segments released in the initial burst");
+            expect_eq(sender.next_release().value(), 1, "next release");
+            for (unsigned i = 0; i < 8; i++) {
+                sender.tick(1);
+                expect_eq(drain(sender), 1, "segments released per millisecond");
+                expect_eq(sender.bytes_in_flight(), (3 + i) * mss, "bytes in flight after a release");
+            }
+            expect_eq(sender.next_release().has_value(), false, "nothing held");
+
+            // 重传不被推迟
+            sender.tick(TCPConfig::TIMEOUT_DFLT);
+            expect_eq(drain(sender), 1, "retransmission");
+        }
+
+        // 发送时间和重传计时器从放行时开始：RTT为10ms的链路测得的SRTT应为10ms
+        {
+            TCPConfig cfg;
+            cfg.fixed_isn = WrappingInt32{static_cast<uint32_t>(rd())};
+            cfg.pacing = true;
+            cfg.pacing_rate = mss * 1000;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 1;
+            TCPSender sender{cfg};
+            sender.fill_window();
+            drain(sender);
+            sender.tick(10);
+            sender.ack_received(sender.next_seqno(), 65535);
+            sender.stream_in().write(string(40 * mss, 'x'));
+            sender.fill_window();
+
+            // 每个段放行10ms后被确认
+            vector<pair<uint64_t, WrappingInt32>> acks{};
+            uint64_t now = 10;
+            for (; now < 100; now++) {
+                while (not sender.segments_out().empty()) {
+                    const TCPSegment &seg = sender.segments_out().front();
+                    acks.emplace_back(now + 10, seg.header().seqno + seg.length_in_sequence_space());
+                    sender.segments_out().pop();
+                }
+                for (const auto &[due, ackno] : acks) {
+                    if (due == now) {
+                        sender.ack_received(ackno, 65535);
+                    }
+                }
+                sender.tick(1);
+            }
+            expect_eq(sender.consecutive_retransmissions(), 0, "held segments were retransmitted");
+            expect_eq(sender.smoothed_rtt().value(), 10, "SRTT with a 10 ms path");
+        }
+
+        // 由窗口和SRTT推导速率
+        {
+            TCPConfig cfg;
+            cfg.fixed_isn = WrappingInt32{static_cast<uint32_t>(rd())};
+            cfg.pacing = true;
+            cfg.congestion_control = CongestionControl::NewReno;
+            TCPSender sender{cfg};
+            sender.fill_window();
+            expect_eq(sender.pacing_rate(), 0, "unpaced before the first RTT sample");
+            sender.tick(100);
+            sender.ack_received(sender.next_seqno(), 65535);
+            // 慢启动：2 * cwnd / SRTT
+            const size_t cwnd = sender.congestion_controller()->cwnd();
+            expect_eq(sender.pacing_rate(), 2 * cwnd * 1000 / 100, "pacing rate in slow start");
+            drain(sender);
+            sender.stream_in().write(string(10 * mss, 'x'));
+            sender.fill_window();
+            expect_eq(drain(sender), 2, "segments released in the initial burst");
+            // 每个MSS约需5ms的令牌
+            sender.tick(4);
+            expect_eq(drain(sender), 1, "segments released after 4 ms");
+            expect_eq(sender.next_release().value(), 1, "next release");
+            sender.tick(1);
+            expect_eq(drain(sender), 1, "segments released after 5 ms");
+            expect_eq(sender.next_release().value(), 5, "next release");
+        }
+
+        // 默认不限速
+        {
+            TCPConfig cfg;
+            cfg.fixed_isn = WrappingInt32{static_cast<uint32_t>(rd())};
+            TCPSender sender{cfg};
+            sender.fill_window();
+            sender.tick(100);
+            sender.ack_received(sender.next_seqno(), 65535);
+            drain(sender);
+            sender.stream_in().write(string(10 * mss, 'x'));
+            sender.fill_window();
+            expect_eq(drain(sender), 10, "unpaced burst");
+            expect_eq(sender.next_release().has_value(), false, "nothing held when unpaced");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
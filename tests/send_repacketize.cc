@@ -0,0 +1,160 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+        // 部分确认后只重传未确认的字节
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.repacketize = true;
+
+            TCPSenderTestHarness test{"trim a partially acknowledged segment", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(AckReceived{WrappingInt32{isn + 3}});
+            test.execute(ExpectBytesInFlight{2});
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_seqno(isn + 3).with_data("cd"));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 5}});
+            test.execute(ExpectBytesInFlight{0});
+        }
+
+        // 重传时合并小段，包括FIN
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.repacketize = true;
+
+            TCPSenderTestHarness test{"coalesce small segments", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            for (const string s : {"a", "b", "c"}) {
+                test.execute(WriteBytes{string(s)});
+                test.execute(ExpectSegment{}.with_data(s));
+            }
+            test.execute(WriteBytes{"d"}.with_end_input(true));
+            test.execute(ExpectSegment{}.with_data("d").with_fin(true));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_seqno(isn + 1).with_data("abcd").with_fin(true));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{5});
+            test.execute(AckReceived{WrappingInt32{isn + 6}});
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectState{TCPSenderStateSummary::FIN_ACKED});
+        }
+
+        // 合并后的重传被确认时不测量RTT
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.repacketize = true;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 1;
+
+            TCPSenderTestHarness test{"no RTT sample from a coalesced retransmission", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(ExpectRetransmissionTimeout{30}.with_srtt(10).with_rttvar(5));
+            for (const string s : {"a", "b", "c"}) {
+                test.execute(WriteBytes{string(s)});
+                test.execute(ExpectSegment{}.with_data(s));
+            }
+            test.execute(Tick{30});
+            test.execute(ExpectSegment{}.with_seqno(isn + 1).with_data("abc"));
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{5});
+            test.execute(AckReceived{WrappingInt32{isn + 4}});
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectRetransmissionTimeout{30}.with_srtt(10).with_rttvar(5));
+        }
+
+        // 合并不超过MSS
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.repacketize = true;
+
+            TCPSenderTestHarness test{"coalescing stops at MAX_PAYLOAD_SIZE", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(5000));
+            test.execute(WriteBytes{string(mss - 1, 'x')});
+            test.execute(ExpectSegment{}.with_payload_size(mss - 1));
+            test.execute(WriteBytes{"y"});
+            test.execute(ExpectSegment{}.with_data("y"));
+            test.execute(WriteBytes{"z"});
+            test.execute(ExpectSegment{}.with_data("z"));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_payload_size(mss));
+            test.execute(ExpectNoSegment{});
+            // 第二次超时只重传剩下的段
+            test.execute(AckReceived{WrappingInt32{isn + 1 + static_cast<uint32_t>(mss)}}.with_win(5000));
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_data("z"));
+        }
+
+        // 部分确认已被SACK的段：裁掉的字节不再算作已SACK
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.repacketize = true;
+            cfg.sack = true;
+
+            TCPSenderTestHarness test{"trim a SACKed segment", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_sack(WrappingInt32{isn + 1}, WrappingInt32{isn + 5}));
+            test.execute(ExpectBytesSacked{4});
+            test.execute(AckReceived{WrappingInt32{isn + 4}});
+            test.execute(ExpectBytesInFlight{1});
+            test.execute(ExpectBytesSacked{1});
+            test.execute(AckReceived{WrappingInt32{isn + 5}});
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectBytesSacked{0});
+        }
+
+        // 未启用时重传整个段
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"no repacketization by default", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(WriteBytes{"abcd"});
+            test.execute(ExpectSegment{}.with_data("abcd"));
+            test.execute(AckReceived{WrappingInt32{isn + 3}});
+            test.execute(Tick{cfg.rt_timeout});
+            test.execute(ExpectSegment{}.with_seqno(isn + 1).with_data("abcd"));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -8,6 +8,7 @@
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 using namespace std;
 
@@ -105,6 +106,53 @@ int main() {
             test.execute(Tick{1}.with_max_retx_exceeded(true));
         }
 
+        // 重传段与首次发送的段共享payload存储
+        {
+            TCPConfig cfg;
+            cfg.fixed_isn = WrappingInt32(rd());
+            TCPSender sender{cfg};
+            sender.fill_window();
+            sender.ack_received(sender.next_seqno(), 1000);
+            sender.segments_out().pop();
+            sender.stream_in().write(string(3 * TCPConfig::MAX_PAYLOAD_SIZE, 'x'));
+            sender.fill_window();
+            const char *first = sender.segments_out().front().payload().str().data();
+            while (not sender.segments_out().empty()) {
+                sender.segments_out().pop();
+            }
+            sender.tick(cfg.rt_timeout);
+            if (sender.segments_out().size() != 1 or sender.segments_out().front().payload().str().data() != first) {
+                throw runtime_error("retransmission copied the payload");
+            }
+        }
+
+        // 跨越环形区与chunk的写入：环形区字节单独成段，chunk字节共享存储
+        {
+            TCPConfig cfg;
+            cfg.fixed_isn = WrappingInt32(rd());
+            TCPSender sender{cfg};
+            sender.fill_window();
+            sender.ack_received(sender.next_seqno(), 10000);
+            sender.segments_out().pop();
+            sender.stream_in().write(string(100, 'r'));
+            string chunk(2 * TCPConfig::MAX_PAYLOAD_SIZE, 'c');
+            const char *chunk_data = chunk.data();
+            sender.stream_in().write(move(chunk));
+            sender.fill_window();
+            if (sender.segments_out().size() != 3 or sender.segments_out().front().payload().str() != string(100, 'r')) {
+                throw runtime_error("ring bytes were not sent in a segment of their own");
+            }
+            sender.segments_out().pop();
+            const char *expected = chunk_data;
+            while (not sender.segments_out().empty()) {
+                if (sender.segments_out().front().payload().str().data() != expected) {
+                    throw runtime_error("segment copied the chunk bytes");
+                }
+                expected += sender.segments_out().front().payload().size();
+                sender.segments_out().pop();
+            }
+        }
+
     } catch (const exception &e) {
         cerr << e.what() << endl;
         return 1;
@@ -0,0 +1,132 @@
+#include "sender_harness.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // SRTT/RTTVAR按RFC 6298更新，重传计时器使用估计的RTO
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 1;
+
+            TCPSenderTestHarness test{"RTT estimate drives the RTO", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            // 第一个样本：SRTT = R，RTTVAR = R/2，RTO = SRTT + 4*RTTVAR
+            test.execute(ExpectRetransmissionTimeout{300}.with_srtt(100).with_rttvar(50));
+
+            test.execute(WriteBytes{"abc"});
+            test.execute(ExpectSegment{}.with_data("abc"));
+            test.execute(Tick{100});
+            test.execute(AckReceived{WrappingInt32{isn + 4}});
+            test.execute(ExpectRetransmissionTimeout{250}.with_srtt(100).with_rttvar(37));
+
+            test.execute(WriteBytes{"def"});
+            test.execute(ExpectSegment{}.with_data("def"));
+            test.execute(Tick{249});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("def"));
+            // 指数退避从估计值开始
+            test.execute(Tick{499});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("def"));
+
+            // Karn算法：重传段的确认不产生样本
+            test.execute(Tick{900});
+            test.execute(AckReceived{WrappingInt32{isn + 7}});
+            test.execute(ExpectRetransmissionTimeout{250}.with_srtt(100).with_rttvar(37));
+        }
+
+        // 累计确认中最新的段未被重传时仍可测量
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 1;
+
+            TCPSenderTestHarness test{"sample from the newest segment acknowledged", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(Tick{1000});
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(ExpectRetransmissionTimeout{1000});
+
+            test.execute(WriteBytes{"a"});
+            test.execute(ExpectSegment{}.with_data("a"));
+            test.execute(Tick{40});
+            test.execute(WriteBytes{"b"});
+            test.execute(ExpectSegment{}.with_data("b"));
+            test.execute(Tick{40});
+            test.execute(AckReceived{WrappingInt32{isn + 3}});
+            test.execute(ExpectRetransmissionTimeout{120}.with_srtt(40).with_rttvar(20));
+        }
+
+        // RTO下限和上限
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.adaptive_rto = true;
+            cfg.rto_min = 200;
+            cfg.rto_max = 700;
+
+            TCPSenderTestHarness test{"RTO clamps", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(ExpectRetransmissionTimeout{200}.with_srtt(0).with_rttvar(0));
+
+            test.execute(WriteBytes{"x"});
+            test.execute(ExpectSegment{}.with_data("x"));
+            test.execute(Tick{200});
+            test.execute(ExpectSegment{}.with_data("x"));
+            test.execute(Tick{400});
+            test.execute(ExpectSegment{}.with_data("x"));
+            // 800ms的退避被限制为700ms
+            test.execute(Tick{699});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("x"));
+        }
+
+        // 未启用时RTO保持配置值
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+
+            TCPSenderTestHarness test{"fixed RTO by default", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn));
+            test.execute(Tick{10});
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            test.execute(ExpectRetransmissionTimeout{TCPConfig::TIMEOUT_DFLT});
+            test.execute(WriteBytes{"x"});
+            test.execute(ExpectSegment{}.with_data("x"));
+            test.execute(Tick{TCPConfig::TIMEOUT_DFLT - 1});
+            test.execute(ExpectNoSegment{});
+            test.execute(Tick{1});
+            test.execute(ExpectSegment{}.with_data("x"));
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,157 @@
+#include "sender_harness.hh"
+#include "tcp_segment.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // SACK options survive serialize and parse
+        {
+            TCPSegment seg;
+            seg.header().syn = true;
+            seg.header().options.sack_permitted = true;
+            seg.header().options.sack = {{WrappingInt32{100}, WrappingInt32{200}},
+                                         {WrappingInt32{300}, WrappingInt32{400}}};
+            seg.header().fit_options();
+            seg.payload() = string("hello");
+
+            TCPSegment parsed;
+            if (parsed.parse(seg.serialize().concatenate()) != ParseResult::NoError) {
+                throw runtime_error("segment with SACK options failed to parse");
+            }
+            if (not(parsed.header() == seg.header()) or parsed.payload().str() != "hello") {
+                throw runtime_error("SACK options changed across serialize/parse:\n" + parsed.header().to_string());
+            }
+
+            // options that do not fit in doff are not written
+            seg.header().doff = 5;
+            if (parsed.parse(seg.serialize().concatenate()) != ParseResult::NoError or
+                parsed.header().options.sack_permitted or not parsed.header().options.sack.empty()) {
+                throw runtime_error("options written beyond doff");
+            }
+        }
+
+        // an RTO retransmits only the oldest segment and discards the SACK scoreboard (RFC 2018 section 8)
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.sack = true;
+            const uint16_t rto = cfg.rt_timeout;
+
+            TCPSenderTestHarness test{"SACK scoreboard cleared on RTO", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_sack_permitted(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            for (const string s : {"a", "b", "c", "d", "e"}) {
+                test.execute(WriteBytes{string(s)});
+                test.execute(ExpectSegment{}.with_data(s));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 1}}
+                             .with_sack(WrappingInt32{isn + 2}, WrappingInt32{isn + 3})
+                             .with_sack(WrappingInt32{isn + 4}, WrappingInt32{isn + 5}));
+            test.execute(ExpectBytesInFlight{5});
+            test.execute(ExpectBytesSacked{2});
+            test.execute(Tick{rto});
+            test.execute(ExpectSegment{}.with_seqno(isn + 1).with_data("a"));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesSacked{0});
+
+            // the receiver may have reneged: SACKed data is retransmitted like any other after the next RTO
+            test.execute(AckReceived{WrappingInt32{isn + 2}});
+            test.execute(Tick{rto});
+            test.execute(ExpectSegment{}.with_seqno(isn + 2).with_data("b"));
+            test.execute(ExpectNoSegment{});
+
+            // new SACK blocks rebuild the scoreboard
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_sack(WrappingInt32{isn + 5}, WrappingInt32{isn + 6}));
+            test.execute(ExpectBytesSacked{1});
+
+            // a block that starts below the ackno still SACKs the bytes above it
+            test.execute(AckReceived{WrappingInt32{isn + 2}}.with_sack(WrappingInt32{isn + 1}, WrappingInt32{isn + 4}));
+            test.execute(ExpectBytesSacked{3});
+            test.execute(AckReceived{WrappingInt32{isn + 6}});
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectBytesSacked{0});
+        }
+
+        // loss recovery resends only the holes below the highest SACKed segment (RFC 6675)
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.sack = true;
+            cfg.fast_retransmit = true;
+
+            TCPSenderTestHarness test{"SACK loss recovery", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_sack_permitted(true).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            for (const string s : {"a", "b", "c", "d", "e", "f"}) {
+                test.execute(WriteBytes{string(s)});
+                test.execute(ExpectSegment{}.with_data(s));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_sack(WrappingInt32{isn + 2}, WrappingInt32{isn + 3}));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_sack(WrappingInt32{isn + 2}, WrappingInt32{isn + 3}));
+            test.execute(ExpectNoSegment{});
+            // third dupack: "a" and "c" are holes, "e" and "f" lie above the highest SACKed segment
+            test.execute(AckReceived{WrappingInt32{isn + 1}}
+                             .with_sack(WrappingInt32{isn + 2}, WrappingInt32{isn + 3})
+                             .with_sack(WrappingInt32{isn + 4}, WrappingInt32{isn + 5}));
+            test.execute(ExpectSegment{}.with_seqno(isn + 1).with_data("a"));
+            test.execute(ExpectSegment{}.with_seqno(isn + 3).with_data("c"));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesSacked{2});
+
+            // partial ACK: "c" was already resent, "e" is a new hole
+            test.execute(AckReceived{WrappingInt32{isn + 3}}
+                             .with_sack(WrappingInt32{isn + 4}, WrappingInt32{isn + 5})
+                             .with_sack(WrappingInt32{isn + 6}, WrappingInt32{isn + 7}));
+            test.execute(ExpectSegment{}.with_seqno(isn + 5).with_data("e"));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesSacked{2});
+
+            // partial ACK without new holes resends nothing
+            test.execute(AckReceived{WrappingInt32{isn + 4}}.with_sack(WrappingInt32{isn + 4}, WrappingInt32{isn + 5}));
+            test.execute(ExpectNoSegment{});
+            test.execute(AckReceived{WrappingInt32{isn + 7}});
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{0});
+            test.execute(ExpectBytesSacked{0});
+        }
+
+        // without SACK the blocks are ignored and only the first segment is retransmitted
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            const uint16_t rto = cfg.rt_timeout;
+
+            TCPSenderTestHarness test{"SACK disabled", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_sack_permitted(false).with_seqno(isn));
+            test.execute(AckReceived{WrappingInt32{isn + 1}});
+            for (const string s : {"a", "b", "c"}) {
+                test.execute(WriteBytes{string(s)});
+                test.execute(ExpectSegment{}.with_data(s));
+            }
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_sack(WrappingInt32{isn + 2}, WrappingInt32{isn + 4}));
+            test.execute(Tick{rto});
+            test.execute(ExpectSegment{}.with_seqno(isn + 1).with_data("a"));
+            test.execute(ExpectNoSegment{});
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
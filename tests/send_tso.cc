@@ -0,0 +1,114 @@
+#include "sender_harness.hh"
+#include "tcp_segment.hh"
+#include "wrapping_integers.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+        const size_t mss = TCPConfig::MAX_PAYLOAD_SIZE;
+
+        // 发送端一次产生一个超级段
+        {
+            TCPConfig cfg;
+            WrappingInt32 isn(rd());
+            cfg.fixed_isn = isn;
+            cfg.tso = true;
+            cfg.send_capacity = 100000;
+
+            TCPSenderTestHarness test{"TSO super segments", cfg};
+            test.execute(ExpectSegment{}.with_syn(true).with_seqno(isn).with_payload_size(0));
+            test.execute(AckReceived{WrappingInt32{isn + 1}}.with_win(65000));
+            test.execute(WriteBytes{string(10 * mss + 5, 'x')});
+            test.execute(ExpectSegment{}.with_seqno(isn + 1).with_payload_size(10 * mss + 5));
+            test.execute(ExpectNoSegment{});
+            test.execute(ExpectBytesInFlight{10 * mss + 5});
+
+            // 窗口允许时不超过TSO_MAX_SEGMENTS个MSS
+            test.execute(AckReceived{WrappingInt32{isn + 1 + static_cast<uint32_t>(10 * mss + 5)}}.with_win(65535));
+            test.execute(WriteBytes{string(TCPConfig::TSO_MAX_SEGMENTS * mss + 1, 'y')});
+            test.execute(ExpectSegment{}.with_payload_size(TCPConfig::TSO_MAX_SEGMENTS * mss));
+            test.execute(ExpectSegment{}.with_payload_size(1));
+        }
+
+        // 切分：序号、SYN/FIN、共享存储和校验和
+        {
+            TCPSegment super;
+            const WrappingInt32 isn(rd());
+            super.header().seqno = isn;
+            super.header().syn = true;
+            super.header().fin = true;
+            super.header().ack = true;
+            super.header().win = 1234;
+            string data(3 * mss + 7, '\0');
+            for (size_t i = 0; i < data.size(); i++) {
+                data[i] = static_cast<char>(rd());
+            }
+            super.payload() = string(data);
+            super.set_gso_size(mss);
+
+            const vector<TCPSegment> wire = super.split();
+            if (wire.size() != 4) {
+                throw runtime_error("expected 4 wire segments, got " + to_string(wire.size()));
+            }
+            size_t offset = 0;
+            for (size_t i = 0; i < wire.size(); i++) {
+                const TCPSegment &seg = wire[i];
+                const WrappingInt32 expected_seqno = i == 0 ? isn : isn + 1 + static_cast<uint32_t>(offset);
+                if (seg.header().seqno != expected_seqno or seg.header().syn != (i == 0) or
+                    seg.header().fin != (i == 3) or seg.gso_size() != 0 or seg.header().win != 1234) {
+                    throw runtime_error("bad header on wire segment " + to_string(i) + ": " +
+                                        seg.header().summary());
+                }
+                if (seg.payload().str() != string_view(data).substr(offset, mss) or
+                    seg.payload().str().data() != super.payload().str().data() + offset) {
+                    throw runtime_error("bad payload on wire segment " + to_string(i));
+                }
+                offset += seg.payload().size();
+            }
+            if (offset != data.size()) {
+                throw runtime_error("wire segments do not cover the payload");
+            }
+
+            const uint32_t pseudo = rd() & 0xffff;
+            const vector<BufferList> serialized = super.serialize_split(pseudo);
+            if (serialized.size() != wire.size()) {
+                throw runtime_error("serialize_split produced the wrong number of segments");
+            }
+            for (size_t i = 0; i < wire.size(); i++) {
+                const string bytes = serialized[i].concatenate();
+                const uint32_t pseudo_with_length = pseudo + static_cast<uint32_t>(bytes.size());
+                if (bytes != wire[i].serialize(pseudo_with_length).concatenate()) {
+                    throw runtime_error("serialize_split differs from split + serialize on segment " + to_string(i));
+                }
+                TCPSegment parsed;
+                if (parsed.parse(string(bytes), pseudo_with_length) != ParseResult::NoError) {
+                    throw runtime_error("wire segment " + to_string(i) + " has a bad checksum");
+                }
+            }
+
+            // 普通段不切分
+            TCPSegment plain;
+            plain.payload() = string("abc");
+            if (plain.split().size() != 1 or plain.serialize_split().size() != 1 or
+                plain.serialize_split(0).front().concatenate() != plain.serialize(3 + 20).concatenate()) {
+                throw runtime_error("an ordinary segment was split");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -13,8 +13,10 @@
 #include <exception>
 #include <iostream>
 #include <optional>
+#include <queue>
 #include <sstream>
 #include <string>
+#include <vector>
 
 const unsigned int DEFAULT_TEST_WINDOW = 137;
 
@@ -101,6 +103,70 @@ struct ExpectBytesInFlight : public SenderExpectation {
     }
 };
 
+// 判断被SACK确认的字节数
+struct ExpectBytesSacked : public SenderExpectation {
+    size_t _n_bytes;
+
+    ExpectBytesSacked(size_t n_bytes) : _n_bytes(n_bytes) {}
+    std::string description() const { return std::to_string(_n_bytes) + " bytes SACKed"; }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        if (sender.bytes_sacked() != _n_bytes) {
+            std::ostringstream ss;
+            ss << "The TCPSender reported " << sender.bytes_sacked() << " bytes SACKed, but there was expected to be "
+               << _n_bytes << " bytes SACKed";
+            throw SenderExpectationViolation(ss.str());
+        }
+    }
+};
+
+// 判断RTT估计值和重传超时时间
+struct ExpectRetransmissionTimeout : public SenderExpectation {
+    unsigned int _rto;
+    std::optional<uint64_t> _srtt{};
+    std::optional<uint64_t> _rttvar{};
+
+    ExpectRetransmissionTimeout(unsigned int rto) : _rto(rto) {}
+
+    ExpectRetransmissionTimeout &with_srtt(uint64_t srtt) {
+        _srtt = srtt;
+        return *this;
+    }
+
+    ExpectRetransmissionTimeout &with_rttvar(uint64_t rttvar) {
+        _rttvar = rttvar;
+        return *this;
+    }
+
+    std::string description() const {
+        std::ostringstream ss;
+        ss << "RTO " << _rto << " ms";
+        if (_srtt.has_value()) {
+            ss << ", SRTT " << _srtt.value() << " ms";
+        }
+        if (_rttvar.has_value()) {
+            ss << ", RTTVAR " << _rttvar.value() << " ms";
+        }
+        return ss.str();
+    }
+
+    void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
+        std::ostringstream ss;
+        ss << "RTO " << sender.retransmission_timeout() << " ms, SRTT ";
+        if (sender.smoothed_rtt().has_value()) {
+            ss << sender.smoothed_rtt().value() << " ms";
+        } else {
+            ss << "(none)";
+        }
+        ss << ", RTTVAR " << sender.rtt_variation() << " ms";
+        if (sender.retransmission_timeout() != _rto or (_srtt.has_value() and sender.smoothed_rtt() != _srtt) or
+            (_rttvar.has_value() and sender.rtt_variation() != _rttvar.value())) {
+            throw SenderExpectationViolation("The TCPSender reported " + ss.str() + ", but expected " +
+                                             description());
+        }
+    }
+};
+
 // 发送列表不应该包含Segment
 struct ExpectNoSegment : public SenderExpectation {
     ExpectNoSegment() {}
@@ -197,11 +263,15 @@ struct Tick : public SenderAction {
 struct AckReceived : public SenderAction {
     WrappingInt32 _ackno;
     std::optional<uint16_t> _window_advertisement{};
+    std::vector<TCPSackBlock> _sack{};
 
     AckReceived(WrappingInt32 ackno) : _ackno(ackno) {}
     std::string description() const {
         std::ostringstream ss;
         ss << "ack " << _ackno.raw_value() << " winsize " << _window_advertisement.value_or(DEFAULT_TEST_WINDOW);
+        for (const auto &block : _sack) {
+            ss << " sack " << block.left.raw_value() << "-" << block.right.raw_value();
+        }
         return ss.str();
     }
 
@@ -210,8 +280,25 @@ struct AckReceived : public SenderAction {
         return *this;
     }
 
+    // 附带SACK块
+    AckReceived &with_sack(WrappingInt32 left, WrappingInt32 right) {
+        _sack.push_back({left, right});
+        return *this;
+    }
+
     void execute(TCPSender &sender, std::queue<TCPSegment> &) const {
-        sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW));
+        if (_sack.empty()) {
+            sender.ack_received(_ackno, _window_advertisement.value_or(DEFAULT_TEST_WINDOW));
+        } else {
+            TCPHeader header;
+            header.ack = true;
+            header.ackno = _ackno;
+            header.win = _window_advertisement.value_or(DEFAULT_TEST_WINDOW);
+            for (const auto &block : _sack) {
+                header.options.sack.push_back(block);
+            }
+            sender.ack_received(header);
+        }
         sender.fill_window();
     }
 };
@@ -238,6 +325,7 @@ struct ExpectSegment : public SenderExpectation {
     std::optional<uint16_t> win{};
     std::optional<size_t> payload_size{};
     std::optional<std::string> data{};
+    std::optional<bool> sack_permitted{};
 
     ExpectSegment &with_ack(bool ack_) {
         ack = ack_;
@@ -296,6 +384,11 @@ struct ExpectSegment : public SenderExpectation {
         return *this;
     }
 
+    ExpectSegment &with_sack_permitted(bool sack_permitted_) {
+        sack_permitted = sack_permitted_;
+        return *this;
+    }
+
     std::string segment_description() const {
         std::ostringstream o;
         o << "(";
@@ -323,6 +416,9 @@ struct ExpectSegment : public SenderExpectation {
         if (payload_size.has_value()) {
             o << "payload_size=" << payload_size.value() << ",";
         }
+        if (sack_permitted.has_value()) {
+            o << (sack_permitted.value() ? "SACK-permitted," : "no SACK-permitted,");
+        }
         if (data.has_value()) {
             o << "\"";
             for (unsigned int i = 0; i < std::min(size_t(16), data.value().size()); i++) {
@@ -372,11 +468,18 @@ struct ExpectSegment : public SenderExpectation {
         if (win.has_value() and seg.header().win != win.value()) {
             throw SegmentExpectationViolation::violated_field("win", win.value(), seg.header().win);
         }
+        if (sack_permitted.has_value() and seg.header().options.sack_permitted != sack_permitted.value()) {
+            throw SegmentExpectationViolation::violated_field(
+                "sack_permitted", sack_permitted.value(), seg.header().options.sack_permitted);
+        }
         if (payload_size.has_value() and seg.payload().size() != payload_size.value()) {
             throw SegmentExpectationViolation::violated_field(
                 "payload_size", payload_size.value(), seg.payload().size());
         }
-        if (seg.payload().size() > TCPConfig::MAX_PAYLOAD_SIZE) {
+        // 超级段按gso_size切分后每段不超过MSS
+        const size_t max_payload = seg.gso_size() == 0 ? TCPConfig::MAX_PAYLOAD_SIZE
+                                                       : TCPConfig::TSO_MAX_SEGMENTS * TCPConfig::MAX_PAYLOAD_SIZE;
+        if (seg.gso_size() > TCPConfig::MAX_PAYLOAD_SIZE or seg.payload().size() > max_payload) {
             throw SegmentExpectationViolation("packet has length (" + std::to_string(seg.payload().size()) +
                                               ") greater than the maximum");
         }
@@ -406,7 +509,7 @@ class TCPSenderTestHarness {
   public:
     TCPSenderTestHarness(const std::string &name_, TCPConfig config)
         : outbound_segments()
-        , sender(config.send_capacity, config.rt_timeout, config.fixed_isn)
+        , sender(config)
         , steps_executed()
         , name(name_) {
         sender.fill_window();
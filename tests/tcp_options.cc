@@ -0,0 +1,116 @@
+#include "tcp_header.hh"
+#include "tcp_segment.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static TCPHeader round_trip(const TCPHeader &header) {
+    TCPSegment seg;
+    seg.header() = header;
+    const string bytes = seg.serialize().concatenate();
+    string in_place(bytes.size(), '\0');
+    if (seg.serialize_into(in_place.data(), in_place.size()) != bytes.size() or in_place != bytes) {
+        throw runtime_error("serialize_into differs from serialize");
+    }
+    TCPSegment parsed;
+    if (const auto res = parsed.parse(string(bytes)); res != ParseResult::NoError) {
+        throw runtime_error("parse failed: " + as_string(res));
+    }
+    return parsed.header();
+}
+
+int main() {
+    try {
+        // every option on a SYN
+        {
+            TCPHeader h;
+            h.syn = true;
+            h.options.mss = 1460;
+            h.options.window_scale = 7;
+            h.options.sack_permitted = true;
+            h.options.timestamps = TCPOptions::Timestamps{0x01020304, 0};
+            h.fit_options();
+            if (h.doff != 5 + 6) {
+                throw runtime_error("unexpected doff " + to_string(h.doff) + " for SYN options");
+            }
+            const TCPHeader parsed = round_trip(h);
+            if (not(parsed == h)) {
+                throw runtime_error("SYN options changed across serialize/parse:\n" + parsed.to_string());
+            }
+        }
+
+        // timestamps leave room for three SACK blocks, not four
+        {
+            TCPHeader h;
+            h.options.timestamps = TCPOptions::Timestamps{7, 8};
+            for (uint32_t i = 0; i < 4; i++) {
+                h.options.sack.push_back({WrappingInt32{100 * i}, WrappingInt32{100 * i + 50}});
+            }
+            h.fit_options();
+            if (h.doff != TCPHeader::MAX_DOFF) {
+                throw runtime_error("doff should be clamped to 15");
+            }
+            const TCPHeader parsed = round_trip(h);
+            if (parsed.options.sack.size() != 3 or not(parsed.options.timestamps == h.options.timestamps)) {
+                throw runtime_error("expected timestamps plus three SACK blocks:\n" + parsed.to_string());
+            }
+        }
+
+        // a bare header carries no options even if they are set
+        {
+            TCPHeader h;
+            h.options.mss = 536;
+            if (not round_trip(h).options.empty()) {
+                throw runtime_error("options written beyond doff");
+            }
+        }
+
+        // unknown options are skipped, oversized window scales are clamped, EOL ends the list
+        {
+            string raw = TCPHeader{}.serialize();
+            raw[12] = static_cast<char>(9 << 4);  // doff = 9: 16 bytes of options
+            raw += string{"\x1e\x04\xab\xcd"                    // unknown kind 30, length 4
+                          "\x03\x03\x20"                        // window scale 32
+                          "\x01"                                // NOP
+                          "\x02\x04\x05\xb4"                    // MSS 1460
+                          "\x00\x02\x04\x05",                   // EOL, then garbage
+                          16};
+            TCPHeader h;
+            NetParser p{string(raw)};
+            if (const auto res = h.parse(p); res != ParseResult::NoError) {
+                throw runtime_error("parse failed: " + as_string(res));
+            }
+            if (h.options.window_scale != TCPOptions::MAX_WINDOW_SCALE or h.options.mss != 1460 or
+                h.options.sack_permitted or p.buffer().size() != 0) {
+                throw runtime_error("unexpected options:\n" + h.to_string());
+            }
+        }
+
+        // malformed option lengths do not read past doff
+        {
+            string raw = TCPHeader{}.serialize();
+            raw[12] = static_cast<char>(6 << 4);
+            raw += string{"\x02\x09\x05\xb4", 4};  // MSS claiming 9 bytes
+            raw += "payload";
+            TCPHeader h;
+            NetParser p{string(raw)};
+            if (const auto res = h.parse(p); res != ParseResult::NoError) {
+                throw runtime_error("parse failed: " + as_string(res));
+            }
+            if (not h.options.empty() or p.buffer().str() != "payload") {
+                throw runtime_error("malformed option was not skipped");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
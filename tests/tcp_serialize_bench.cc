@@ -0,0 +1,115 @@
+#include "tcp_config.hh"
+#include "tcp_segment.hh"
+#include "util.hh"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//! The serialization this tree used before serialize_into: the header is built twice, the checksum
+//! is summed a byte at a time, and the resulting BufferList is copied out
+static size_t serialize_two_pass(const TCPSegment &seg, char *out, const uint32_t pseudo) {
+    TCPHeader header_out = seg.header();
+    header_out.cksum = 0;
+    InternetChecksum check(pseudo);
+    check.add(header_out.serialize());
+    check.add(seg.payload());
+    header_out.cksum = check.value();
+
+    BufferList ret;
+    ret.append(header_out.serialize());
+    ret.append(seg.payload());
+    size_t len = 0;
+    for (const Buffer &buf : ret.buffers()) {
+        memcpy(out + len, buf.str().data(), buf.size());
+        len += buf.size();
+    }
+    return len;
+}
+
+//! Serialize `segments` `rounds` times with `fn` and return segments per second
+template <typename F>
+static double segments_per_second(const vector<TCPSegment> &segments, const size_t rounds, F &&fn) {
+    vector<char> out(TCPHeader::LENGTH + 40 + TCPConfig::MAX_PAYLOAD_SIZE);
+    size_t bytes = 0;
+    const auto start = chrono::steady_clock::now();
+    for (size_t r = 0; r < rounds; r++) {
+        for (const TCPSegment &seg : segments) {
+            bytes += fn(seg, out.data(), out.size());
+        }
+    }
+    const chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    if (bytes == 0) {
+        throw runtime_error("nothing serialized");
+    }
+    return static_cast<double>(rounds * segments.size()) / elapsed.count();
+}
+
+int main(int argc, char *argv[]) {
+    try {
+        const size_t total = argc > 1 ? stoul(argv[1]) : 1000000;
+        const uint32_t pseudo = 0x1234;
+
+        // 各种长度的载荷（含奇数长度），先检查三种方法结果一致
+        vector<TCPSegment> segments;
+        for (size_t len : {size_t{0}, size_t{1}, size_t{7}, size_t{536}, size_t{1001}, TCPConfig::MAX_PAYLOAD_SIZE}) {
+            TCPSegment seg;
+            seg.header().seqno = WrappingInt32{static_cast<uint32_t>(len * 2654435761u)};
+            seg.header().ack = true;
+            seg.header().win = 65535;
+            string payload(len, '\0');
+            for (size_t i = 0; i < len; i++) {
+                payload[i] = static_cast<char>(i * 131 + len);
+            }
+            seg.payload() = move(payload);
+            segments.push_back(seg);
+        }
+        for (const TCPSegment &seg : segments) {
+            const string expected = seg.serialize(pseudo).concatenate();
+            string before(expected.size(), '\0');
+            string after(expected.size(), '\0');
+            if (serialize_two_pass(seg, before.data(), pseudo) != expected.size() or before != expected or
+                seg.serialize_into(after.data(), after.size(), pseudo) != expected.size() or after != expected) {
+                throw runtime_error("serializers disagree on a " + to_string(seg.payload().size()) + "-byte payload");
+            }
+        }
+
+        // 只测MSS大小的段
+        const vector<TCPSegment> full{segments.back()};
+        const double before = segments_per_second(full, total, [&](const TCPSegment &seg, char *out, size_t) {
+            return serialize_two_pass(seg, out, pseudo);
+        });
+        const double current = segments_per_second(full, total, [&](const TCPSegment &seg, char *out, size_t) {
+            const BufferList serialized = seg.serialize(pseudo);
+            size_t len = 0;
+            for (const Buffer &buf : serialized.buffers()) {
+                memcpy(out + len, buf.str().data(), buf.size());
+                len += buf.size();
+            }
+            return len;
+        });
+        const double after = segments_per_second(full, total, [&](const TCPSegment &seg, char *out, size_t room) {
+            return seg.serialize_into(out, room, pseudo);
+        });
+
+        cout << fixed << setprecision(0);
+        cout << total << " segments of " << TCPConfig::MAX_PAYLOAD_SIZE << " payload bytes into a flat buffer:\n";
+        cout << "  two-pass serialize (before):  " << before << " segments/s\n";
+        cout << "  serialize() + copy:           " << current << " segments/s\n";
+        cout << "  serialize_into:               " << after << " segments/s\n";
+    } catch (const exception &e) {
+        cerr << "Exception: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,146 @@
+#include "tcp_config.hh"
+#include "tcp_receiver.hh"
+#include "tcp_segment.hh"
+#include "tcp_sender.hh"
+#include "util.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static constexpr size_t WINDOW = 16 << 20;
+static constexpr size_t TRANSFER = 100 << 20;
+
+// 按偏移生成可校验的数据
+static string pattern(const size_t offset, const size_t len) {
+    string s(len, 0);
+    for (size_t i = 0; i < len; i++) {
+        s[i] = static_cast<char>((offset + i) % 251);
+    }
+    return s;
+}
+
+// 经过序列化和解析，模拟线路
+static TCPSegment wire(const TCPSegment &seg) {
+    TCPSegment out;
+    if (const auto res = out.parse(seg.serialize().concatenate()); res != ParseResult::NoError) {
+        throw runtime_error("segment failed to parse: " + as_string(res));
+    }
+    return out;
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // the announced shift covers the capacity
+        {
+            TCPConfig cfg;
+            cfg.recv_capacity = 64000;
+            if (cfg.recv_window_scale() != 0) {
+                throw runtime_error("64000 bytes should not need scaling");
+            }
+            cfg.recv_capacity = WINDOW;
+            if (cfg.recv_window_scale() != 9) {
+                throw runtime_error("16 MiB should need a shift of 9");
+            }
+        }
+
+        // 100 MB through a 16 MB window
+        {
+            TCPConfig cfg;
+            cfg.window_scaling = true;
+            cfg.send_capacity = WINDOW;
+            cfg.recv_capacity = WINDOW;
+            cfg.fixed_isn = WrappingInt32{static_cast<uint32_t>(rd())};
+
+            TCPSender sender{cfg};
+            TCPReceiver receiver{cfg};
+
+            // handshake: our SYN, then the peer's SYN/ACK announcing its own shift
+            sender.fill_window();
+            TCPSegment syn = wire(sender.segments_out().front());
+            sender.segments_out().pop();
+            if (syn.header().options.window_scale != cfg.recv_window_scale()) {
+                throw runtime_error("SYN did not carry the window scale option");
+            }
+            receiver.segment_received(syn);
+
+            TCPHeader syn_ack;
+            syn_ack.syn = true;
+            syn_ack.ack = true;
+            syn_ack.ackno = receiver.ackno().value();
+            syn_ack.win = static_cast<uint16_t>(min<size_t>(receiver.window_size(), UINT16_MAX));
+            syn_ack.options.window_scale = receiver.window_scale();
+            sender.ack_received(syn_ack);
+
+            size_t written = 0, received = 0, max_in_flight = 0;
+            while (not receiver.stream_out().eof()) {
+                // application writes as much as the stream accepts
+                if (written < TRANSFER) {
+                    const size_t n = min(TRANSFER - written, sender.stream_in().remaining_capacity());
+                    written += sender.stream_in().write(pattern(written, n));
+                    if (written == TRANSFER) {
+                        sender.stream_in().end_input();
+                    }
+                }
+
+                sender.fill_window();
+                max_in_flight = max(max_in_flight, sender.bytes_in_flight());
+                if (sender.segments_out().empty()) {
+                    throw runtime_error("sender stalled with " + to_string(sender.bytes_in_flight()) +
+                                        " bytes in flight");
+                }
+                while (not sender.segments_out().empty()) {
+                    receiver.segment_received(wire(sender.segments_out().front()));
+                    sender.segments_out().pop();
+                }
+
+                // application reads everything, then the receiver acks with a scaled window
+                const string data = receiver.stream_out().read(receiver.stream_out().buffer_size());
+                if (data != pattern(received, data.size())) {
+                    throw runtime_error("corrupted data at offset " + to_string(received));
+                }
+                received += data.size();
+
+                TCPHeader ack;
+                ack.ack = true;
+                ack.ackno = receiver.ackno().value();
+                ack.win = receiver.window_advertisement();
+                sender.ack_received(ack);
+            }
+
+            if (received != TRANSFER) {
+                throw runtime_error("received " + to_string(received) + " bytes");
+            }
+            if (max_in_flight < WINDOW - (1 << cfg.recv_window_scale())) {
+                throw runtime_error("only " + to_string(max_in_flight) + " bytes were ever in flight");
+            }
+        }
+
+        // without scaling on both sides the window stays clamped to 16 bits
+        {
+            TCPConfig cfg;
+            cfg.window_scaling = true;
+            cfg.recv_capacity = WINDOW;
+            TCPReceiver receiver{cfg};
+            TCPSegment syn;
+            syn.header().syn = true;
+            receiver.segment_received(syn);
+            if (receiver.window_advertisement() != UINT16_MAX) {
+                throw runtime_error("window should be clamped when the peer did not offer scaling");
+            }
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
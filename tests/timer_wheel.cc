@@ -0,0 +1,161 @@
+#include "tcp_config.hh"
+#include "tcp_sender.hh"
+#include "timer_wheel.hh"
+#include "util.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static void expect(const bool cond, const string &what) {
+    if (not cond) {
+        throw runtime_error(what);
+    }
+}
+
+int main() {
+    try {
+        auto rd = get_random_generator();
+
+        // 每个定时器恰好在截止时间触发，跨越各层级
+        {
+            TimerWheel wheel{12345};
+            vector<uint64_t> deadlines{};
+            for (const uint64_t delay : {1ul, 2ul, 255ul, 256ul, 257ul, 1000ul, 65535ul, 65536ul, 65537ul,
+                                         1ul << 24, (1ul << 24) + 7, (1ul << 32) + 3}) {
+                deadlines.push_back(wheel.now() + delay);
+            }
+            vector<uint64_t> fired_at(deadlines.size(), 0);
+            for (size_t i = 0; i < deadlines.size(); i++) {
+                wheel.schedule_at(deadlines[i], [&, i] { fired_at[i] = wheel.now(); });
+            }
+            expect(wheel.size() == deadlines.size(), "size after scheduling");
+            // 按随机步长推进
+            while (wheel.size() > 0) {
+                wheel.advance(uniform_int_distribution<uint64_t>{1, 5000}(rd));
+                if (wheel.now() > deadlines.back() + 5000) {
+                    break;
+                }
+            }
+            for (size_t i = 0; i < deadlines.size(); i++) {
+                expect(fired_at[i] == deadlines[i], "timer " + to_string(i) + " fired at the wrong time");
+            }
+        }
+        {
+            TimerWheel wheel;
+            vector<uint64_t> fired_at(300, 0);
+            for (uint64_t i = 0; i < fired_at.size(); i++) {
+                const uint64_t deadline = 1 + (i * 7919) % 70000;
+                wheel.schedule_at(deadline, [&, i, deadline] {
+                    expect(wheel.now() == deadline, "timer fired at the wrong time");
+                    fired_at[i] = deadline;
+                });
+            }
+            wheel.advance(70001);
+            for (const uint64_t t : fired_at) {
+                expect(t != 0, "timer never fired");
+            }
+        }
+
+        // 取消、过期的TimerId、回调中重新调度
+        {
+            TimerWheel wheel;
+            unsigned fired = 0;
+            const auto a = wheel.schedule_in(10, [&] { fired++; });
+            const auto b = wheel.schedule_in(10, [&] { fired++; });
+            expect(wheel.cancel(a), "cancel a pending timer");
+            expect(not wheel.cancel(a), "cancel twice");
+            wheel.advance(10);
+            expect(fired == 1 and wheel.size() == 0, "only the uncancelled timer fires");
+            expect(not wheel.cancel(b), "cancel a timer that fired");
+            expect(not wheel.cancel(TimerWheel::NO_TIMER), "cancel NO_TIMER");
+
+            // 周期定时器
+            function<void()> periodic = [&] {
+                fired++;
+                wheel.schedule_in(100, periodic);
+            };
+            wheel.schedule_in(100, periodic);
+            wheel.advance(1000);
+            expect(fired == 11, "periodic timer");
+
+            // 截止时间已过的定时器在下一毫秒触发
+            TimerWheel later{500};
+            bool late = false;
+            later.schedule_at(100, [&] { late = true; });
+            later.advance(1);
+            expect(late, "past deadline fires on the next millisecond");
+        }
+
+        // 一百万个空闲连接：每毫秒的开销与定时器数量无关
+        {
+            TimerWheel wheel;
+            size_t fired = 0;
+            for (uint64_t i = 0; i < 1000000; i++) {
+                wheel.schedule_in(60000 + i % 1000, [&fired] { fired++; });
+            }
+            wheel.advance(59999);
+            expect(fired == 0 and wheel.size() == 1000000, "idle timers fired early");
+            wheel.advance(1000);
+            expect(fired == 1000000 and wheel.size() == 0, "idle timers did not all fire");
+        }
+
+        // TCPSender：由时间轮驱动重传计时器
+        {
+            TCPConfig cfg;
+            cfg.fixed_isn = WrappingInt32{static_cast<uint32_t>(rd())};
+            TimerWheel wheel;
+            TCPSender sender{cfg};
+            sender.attach_timer_wheel(wheel);
+            sender.fill_window();
+            expect(sender.segments_out().size() == 1, "SYN sent");
+            sender.segments_out().pop();
+            expect(wheel.size() == 1, "retransmission timer armed");
+
+            wheel.advance(cfg.rt_timeout - 1);
+            expect(sender.segments_out().empty(), "retransmitted early");
+            wheel.advance(1);
+            expect(sender.segments_out().size() == 1 and sender.consecutive_retransmissions() == 1,
+                   "retransmitted on expiry");
+            sender.segments_out().pop();
+
+            // 退避后的超时
+            wheel.advance(2 * cfg.rt_timeout - 1);
+            expect(sender.segments_out().empty(), "retransmitted before the backed-off timeout");
+            wheel.advance(1);
+            expect(sender.segments_out().size() == 1, "retransmitted after the backed-off timeout");
+            sender.segments_out().pop();
+
+            // 全部确认后计时器停止
+            wheel.advance(10);
+            sender.ack_received(sender.next_seqno(), 1000);
+            expect(wheel.size() == 0, "timer cancelled once everything is acknowledged");
+            sender.stream_in().write("hi");
+            sender.fill_window();
+            sender.segments_out().pop();
+            expect(wheel.size() == 1, "timer re-armed for new data");
+            wheel.advance(cfg.rt_timeout);
+            expect(sender.segments_out().size() == 1, "data retransmitted on expiry");
+
+            auto gone = make_unique<TCPSender>(cfg);
+            gone->attach_timer_wheel(wheel);
+            gone->fill_window();
+            const size_t pending = wheel.size();
+            gone.reset();
+            expect(wheel.size() == pending - 1, "destroying a sender cancels its timer");
+        }
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}